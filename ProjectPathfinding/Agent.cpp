@@ -1,4 +1,5 @@
 #include "Agent.h"
+#include <algorithm>
 
 Agent::Agent()
     : m_currentPathIndex(0)
@@ -33,6 +34,20 @@ std::optional<Vec2i> Agent::getPosition() const {
     return m_path[m_currentPathIndex];
 }
 
+std::optional<Vec2i> Agent::getNextPosition() const {
+    if (m_path.empty()) {
+        return std::nullopt;
+    }
+    return m_path[hasReachedDestination() ? m_currentPathIndex : m_currentPathIndex + 1];
+}
+
+float Agent::getMoveProgress() const {
+    if (hasReachedDestination() || m_moveInterval <= 0.0f) {
+        return 0.0f;
+    }
+    return std::min(m_moveTimer / m_moveInterval, 1.0f);
+}
+
 bool Agent::hasReachedDestination() const {
     if (m_path.empty()) {
         return true;
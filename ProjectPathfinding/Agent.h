@@ -13,6 +13,12 @@ public:
 
     std::optional<Vec2i> getPosition() const;
 
+    // Cell the agent is currently moving into, same as getPosition() once it has arrived
+    std::optional<Vec2i> getNextPosition() const;
+
+    // How far the current step has progressed, from 0 to 1
+    float getMoveProgress() const;
+
     bool hasReachedDestination() const;
 
     void setMoveInterval(float seconds) { m_moveInterval = seconds; }
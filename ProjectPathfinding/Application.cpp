@@ -1,22 +1,109 @@
 #include "Application.h"
 #include "Config.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 
-Application::Application(int gridWidth, int gridHeight, int cellSize)
+namespace {
+
+    // Visits every cell on the line from 'from' (exclusive) to 'to'
+    // (inclusive), so a fast drag still paints a connected stroke
+    template <typename Visit>
+    void forEachCellOnLine(const Vec2i& from, const Vec2i& to, Visit&& visit) {
+        int dx = std::abs(to.x - from.x);
+        int dy = -std::abs(to.y - from.y);
+        int stepX = from.x < to.x ? 1 : -1;
+        int stepY = from.y < to.y ? 1 : -1;
+        int error = dx + dy;
+
+        Vec2i pos = from;
+        while (pos != to) {
+            int doubled = 2 * error;
+            if (doubled >= dy) {
+                error += dy;
+                pos.x += stepX;
+            }
+            if (doubled <= dx) {
+                error += dx;
+                pos.y += stepY;
+            }
+            visit(pos);
+        }
+    }
+
+    sf::Color blend(const sf::Color& from, const sf::Color& to, float amount) {
+        auto channel = [amount](sf::Uint8 a, sf::Uint8 b) {
+            return static_cast<sf::Uint8>(a + (b - a) * amount + 0.5f);
+        };
+        return sf::Color(channel(from.r, to.r), channel(from.g, to.g), channel(from.b, to.b));
+    }
+
+} // anonymous namespace
+
+Application::Application(int gridWidth, int gridHeight, int cellSize,
+    const SessionOptions& options)
     : m_grid(gridWidth, gridHeight)
+    , m_options(options)
     , m_cellSize(static_cast<float>(cellSize))
     , m_currentMode(PlacementMode::Obstacle)
-    , m_window(sf::VideoMode(gridWidth* cellSize, gridHeight* cellSize + HUD_HEIGHT),
-        "A* Pathfinding Visualizer")
+    , m_pathVersion(0)
+    , m_lastAgentPathVersion(0)
+    , m_editLogBase(0)
+    , m_stopSimulation(false)
+    , m_quitRequested(false)
+    , m_isPanning(false)
     , m_gridVertices(sf::Quads)
     , m_pathVertices(sf::Quads)
-    , m_needsRebuild(true)
+    , m_renderedGridVersion(0)
+    , m_renderedPathVersion(0)
+    , m_isDragging(false)
+    , m_dragIsLeft(false)
     , m_fontLoaded(false)
 {
+    if (m_options.mode == SessionMode::Replay) {
+        if (!m_player.load(m_options.inputLogPath)) {
+            m_options.mode = SessionMode::Interactive;
+            m_options.headless = false;
+        }
+        else if (m_player.getGridWidth() != gridWidth || m_player.getGridHeight() != gridHeight) {
+            // Replayed clicks are in grid coordinates, so the grid must match the recording
+            m_grid = Grid(m_player.getGridWidth(), m_player.getGridHeight());
+        }
+    }
+    else {
+        m_options.headless = false;
+    }
+
+    // Recording needs input and frame deltas on the same thread, in lockstep
+    if (m_options.mode != SessionMode::Interactive) {
+        m_options.pipelined = false;
+    }
+    m_options.simulationHz = std::max(m_options.simulationHz, 1);
+
+    if (m_options.mode == SessionMode::Record) {
+        m_recorder.open(m_options.inputLogPath, m_grid.getWidth(), m_grid.getHeight());
+    }
+
     m_grid.setStart({ 0, 0 });
-    m_grid.setEnd({ gridWidth - 1, gridHeight - 1 });
+    m_grid.setEnd({ m_grid.getWidth() - 1, m_grid.getHeight() - 1 });
+
+    if (!m_options.headless) {
+        // Small grids get a window that fits them exactly; larger ones are
+        // capped and start zoomed out to fit
+        const unsigned viewportWidth = std::min(static_cast<unsigned>(m_grid.getWidth() * cellSize), Config::MAX_WINDOW_WIDTH);
+        const unsigned viewportHeight = std::min(static_cast<unsigned>(m_grid.getHeight() * cellSize), Config::MAX_WINDOW_HEIGHT);
+
+        m_window.create(sf::VideoMode(viewportWidth, viewportHeight + HUD_HEIGHT),
+            "A* Pathfinding Visualizer");
 
-    m_fontLoaded = loadFont();
+        m_camera.setViewportSize(sf::Vector2f(static_cast<float>(viewportWidth), static_cast<float>(viewportHeight)));
+        m_camera.setWorldSize(sf::Vector2f(m_grid.getWidth() * m_cellSize, m_grid.getHeight() * m_cellSize));
+        m_camera.fit();
+
+        m_fontLoaded = loadFont();
+    }
 
     if (m_fontLoaded) {
         m_hudText.setFont(m_font);
@@ -25,6 +112,15 @@ Application::Application(int gridWidth, int gridHeight, int cellSize)
     }
 
     recalculatePath();
+
+    m_editLogBase = m_grid.getVersion();
+    m_grid.addListener([this](const Grid&, const GridChangeSet& changes) {
+        onGridChanged(changes);
+    });
+
+    if (!m_options.headless) {
+        publishSnapshot();
+    }
 }
 
 bool Application::loadFont() {
@@ -39,10 +135,168 @@ bool Application::loadFont() {
 }
 
 void Application::run() {
+    if (m_options.mode == SessionMode::Replay) {
+        runReplay();
+    }
+    else if (m_options.pipelined) {
+        runPipelined();
+    }
+    else {
+        runInteractive();
+    }
+
+    m_recorder.close();
+
+    if (m_options.mode != SessionMode::Interactive) {
+        printSessionStats();
+    }
+}
+
+void Application::runInteractive() {
+    using FrameClock = std::chrono::steady_clock;
+
+    m_deltaClock.restart();
+
+    while (m_window.isOpen()) {
+        auto frameStart = FrameClock::now();
+
+        // All edits made by this frame's input land in one commit, so a
+        // drag across many cells costs one path search and one vertex patch
+        m_grid.beginEdit();
+        handleEvents();
+        m_grid.commitEdit();
+
+        if (m_quitRequested.load()) {
+            m_window.close();
+        }
+
+        update(m_deltaClock.restart().asSeconds());
+
+        if (m_window.isOpen()) {
+            publishSnapshot();
+            render();
+        }
+
+        std::chrono::duration<double> frameTime = FrameClock::now() - frameStart;
+        m_stats.frames++;
+        m_stats.totalFrameSeconds += frameTime.count();
+        m_stats.maxFrameSeconds = std::max(m_stats.maxFrameSeconds, frameTime.count());
+    }
+}
+
+void Application::runPipelined() {
+    using FrameClock = std::chrono::steady_clock;
+
+    m_stopSimulation.store(false);
+    m_simulationThread = std::thread(&Application::simulationLoop, this);
+
+    // The render thread only polls the window and draws snapshots, so its
+    // frame rate no longer depends on how long a tick or a search takes
     while (m_window.isOpen()) {
+        auto frameStart = FrameClock::now();
+
         handleEvents();
-        update();
+
+        if (m_quitRequested.load()) {
+            m_window.close();
+            break;
+        }
+
         render();
+
+        std::chrono::duration<double> frameTime = FrameClock::now() - frameStart;
+        m_stats.frames++;
+        m_stats.totalFrameSeconds += frameTime.count();
+        m_stats.maxFrameSeconds = std::max(m_stats.maxFrameSeconds, frameTime.count());
+    }
+
+    m_stopSimulation.store(true);
+    m_simulationThread.join();
+}
+
+void Application::simulationLoop() {
+    using TickClock = std::chrono::steady_clock;
+
+    const float timestep = 1.0f / static_cast<float>(m_options.simulationHz);
+    const auto tickDuration = std::chrono::duration_cast<TickClock::duration>(
+        std::chrono::duration<float>(timestep));
+
+    auto nextTick = TickClock::now();
+    std::vector<InputEvent> events;
+
+    while (!m_stopSimulation.load()) {
+        {
+            std::lock_guard<std::mutex> lock(m_inputMutex);
+            events.swap(m_pendingInput);
+        }
+
+        // Same per-frame transaction as the serial loop, once per tick here
+        m_grid.beginEdit();
+        for (const InputEvent& event : events) {
+            dispatchInput(event);
+        }
+        m_grid.commitEdit();
+        events.clear();
+
+        update(timestep);
+        publishSnapshot();
+
+        // Skip ticks rather than spiral after a stall (e.g. a long search)
+        nextTick += tickDuration;
+        auto now = TickClock::now();
+        if (now > nextTick + tickDuration * 4) {
+            nextTick = now;
+        }
+        std::this_thread::sleep_until(nextTick);
+    }
+}
+
+void Application::runReplay() {
+    using FrameClock = std::chrono::steady_clock;
+
+    while (m_player.hasNextFrame()) {
+        if (!m_options.headless) {
+            if (!m_window.isOpen()) {
+                break;
+            }
+
+            // Live input is ignored during replay, apart from closing the
+            // window and moving the camera
+            sf::Event event;
+            while (m_window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    m_window.close();
+                }
+                handleCameraEvent(event);
+            }
+        }
+
+        auto frameStart = FrameClock::now();
+
+        // The recorded delta is used instead of the wall clock, so every
+        // replay steps the simulation identically regardless of frame rate
+        const InputFrame& frame = m_player.nextFrame();
+        m_grid.beginEdit();
+        for (const InputEvent& event : frame.events) {
+            dispatchInput(event);
+        }
+        m_grid.commitEdit();
+
+        if (m_quitRequested.load() && !m_options.headless) {
+            m_window.close();
+        }
+
+        update(frame.deltaTime);
+
+        if (!m_options.headless && m_window.isOpen()) {
+            publishSnapshot();
+            render();
+        }
+
+        std::chrono::duration<double> frameTime = FrameClock::now() - frameStart;
+        m_stats.frames++;
+        m_stats.totalFrameSeconds += frameTime.count();
+        m_stats.maxFrameSeconds = std::max(m_stats.maxFrameSeconds, frameTime.count());
     }
 }
 
@@ -53,18 +307,132 @@ void Application::handleEvents() {
             m_window.close();
         }
 
-        if (event.type == sf::Event::MouseButtonPressed) {
-            int gridX = static_cast<int>(event.mouseButton.x / m_cellSize);
-            int gridY = static_cast<int>(event.mouseButton.y / m_cellSize);
-            Vec2i gridPos = { gridX, gridY };
+        if (handleCameraEvent(event)) {
+            continue;
+        }
+
+        Vec2i gridPos;
 
+        if (event.type == sf::Event::MouseButtonPressed && screenToCell(event.mouseButton.x, event.mouseButton.y, gridPos)) {
             bool isLeftClick = (event.mouseButton.button == sf::Mouse::Left);
-            handleMouseClick(gridPos, isLeftClick);
+            submitInput(InputEvent::mouseClick(gridPos, isLeftClick));
+
+            m_isDragging = isLeftClick || event.mouseButton.button == sf::Mouse::Right;
+            m_dragIsLeft = isLeftClick;
+            m_lastDragCell = gridPos;
+        }
+
+        if (event.type == sf::Event::MouseButtonReleased) {
+            m_isDragging = false;
+        }
+
+        if (event.type == sf::Event::MouseMoved && m_isDragging
+            && screenToCell(event.mouseMove.x, event.mouseMove.y, gridPos)) {
+            forEachCellOnLine(m_lastDragCell, gridPos, [&](const Vec2i& pos) {
+                submitInput(InputEvent::mouseDrag(pos, m_dragIsLeft));
+            });
+            m_lastDragCell = gridPos;
         }
 
         if (event.type == sf::Event::KeyPressed) {
-            handleKeyPress(event.key.code);
+            submitInput(InputEvent::keyPress(static_cast<int>(event.key.code)));
+        }
+    }
+}
+
+bool Application::handleCameraEvent(const sf::Event& event) {
+    switch (event.type) {
+    case sf::Event::Resized:
+        m_camera.setViewportSize(sf::Vector2f(static_cast<float>(event.size.width),
+            static_cast<float>(std::max(static_cast<int>(event.size.height) - HUD_HEIGHT, 1))));
+        return true;
+
+    case sf::Event::MouseWheelScrolled:
+        if (event.mouseWheelScroll.wheel != sf::Mouse::VerticalWheel) {
+            return false;
+        }
+        m_camera.zoomAt(sf::Vector2f(static_cast<float>(event.mouseWheelScroll.x), static_cast<float>(event.mouseWheelScroll.y)),
+            std::pow(Config::ZOOM_STEP, -event.mouseWheelScroll.delta));
+        return true;
+
+    case sf::Event::MouseButtonPressed:
+        if (event.mouseButton.button != sf::Mouse::Middle) {
+            return false;
+        }
+        m_isPanning = true;
+        m_lastPanPixel = sf::Vector2f(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+        return true;
+
+    case sf::Event::MouseButtonReleased:
+        if (event.mouseButton.button != sf::Mouse::Middle) {
+            return false;
+        }
+        m_isPanning = false;
+        return true;
+
+    case sf::Event::MouseMoved:
+    {
+        if (!m_isPanning) {
+            return false;
+        }
+
+        // Drag the grid along with the cursor
+        sf::Vector2f pixel(static_cast<float>(event.mouseMove.x), static_cast<float>(event.mouseMove.y));
+        m_camera.pan(m_lastPanPixel - pixel);
+        m_lastPanPixel = pixel;
+        return true;
+    }
+
+    case sf::Event::KeyPressed:
+        switch (event.key.code) {
+        case sf::Keyboard::Left:  m_camera.pan({ -Config::PAN_STEP_PIXELS, 0.0f }); return true;
+        case sf::Keyboard::Right: m_camera.pan({ Config::PAN_STEP_PIXELS, 0.0f });  return true;
+        case sf::Keyboard::Up:    m_camera.pan({ 0.0f, -Config::PAN_STEP_PIXELS }); return true;
+        case sf::Keyboard::Down:  m_camera.pan({ 0.0f, Config::PAN_STEP_PIXELS });  return true;
+        case sf::Keyboard::F:     m_camera.fit();                                   return true;
+        default:                  return false;
         }
+
+    default:
+        return false;
+    }
+}
+
+bool Application::screenToCell(int x, int y, Vec2i& cell) const {
+    if (static_cast<float>(y) >= m_camera.getViewportSize().y) {
+        return false;
+    }
+
+    sf::Vector2f world = m_camera.screenToWorld(sf::Vector2f(static_cast<float>(x), static_cast<float>(y)));
+    cell = { static_cast<int>(std::floor(world.x / m_cellSize)), static_cast<int>(std::floor(world.y / m_cellSize)) };
+    return true;
+}
+
+void Application::submitInput(const InputEvent& event) {
+    if (!m_options.pipelined) {
+        dispatchInput(event);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_inputMutex);
+    m_pendingInput.push_back(event);
+}
+
+void Application::dispatchInput(const InputEvent& event) {
+    m_recorder.recordEvent(event);
+
+    switch (event.type) {
+    case InputEvent::Type::MouseClick:
+        handleMouseClick(event.gridPos, event.isLeftClick);
+        break;
+
+    case InputEvent::Type::MouseDrag:
+        handleMouseDrag(event.gridPos, event.isLeftClick);
+        break;
+
+    case InputEvent::Type::KeyPress:
+        handleKeyPress(static_cast<sf::Keyboard::Key>(event.keyCode));
+        break;
     }
 }
 
@@ -74,23 +442,19 @@ void Application::handleMouseClick(const Vec2i& gridPos, bool isLeftClick) {
         return;
     }
 
+    // Grid edits are picked up by onGridChanged when the frame commits
     if (isLeftClick) {
         switch (m_currentMode) {
         case PlacementMode::Obstacle:
-            if (m_grid.getCellType(gridPos) == CellType::Walkable) {
-                m_grid.setCellType(gridPos, CellType::Obstacle);
-                recalculatePath();
-            }
+            paintCell(gridPos, true);
             break;
 
         case PlacementMode::Start:
             m_grid.setStart(gridPos);
-            recalculatePath();
             break;
 
         case PlacementMode::End:
             m_grid.setEnd(gridPos);
-            recalculatePath();
             break;
 
         case PlacementMode::Navigate:
@@ -101,11 +465,50 @@ void Application::handleMouseClick(const Vec2i& gridPos, bool isLeftClick) {
         }
     }
     else {
-        if (m_grid.getCellType(gridPos) == CellType::Obstacle) {
-            m_grid.setCellType(gridPos, CellType::Walkable);
-            recalculatePath();
+        paintCell(gridPos, false);
+    }
+}
+
+void Application::handleMouseDrag(const Vec2i& gridPos, bool isLeftClick) {
+    if (!m_grid.isInBounds(gridPos)) {
+        return;
+    }
+
+    // Dragging paints walls in obstacle mode and erases them in any mode,
+    // matching what a click on the same cell would do
+    if (!isLeftClick || m_currentMode == PlacementMode::Obstacle) {
+        paintCell(gridPos, isLeftClick);
+    }
+}
+
+void Application::paintCell(const Vec2i& gridPos, bool isLeftClick) {
+    CellType type = m_grid.getCellType(gridPos);
+
+    if (isLeftClick && type == CellType::Walkable) {
+        m_grid.setCellType(gridPos, CellType::Obstacle);
+    }
+    else if (!isLeftClick && type == CellType::Obstacle) {
+        m_grid.setCellType(gridPos, CellType::Walkable);
+    }
+}
+
+void Application::onGridChanged(const GridChangeSet& changes) {
+    // Logged for the snapshots, which only copy and redraw these cells
+    if (!m_options.headless) {
+        for (const Vec2i& pos : changes.cells) {
+            m_editLog.push_back({ changes.version, pos });
+        }
+
+        // Drop whole versions from the front until the log fits again
+        while (m_editLog.size() > MAX_LOGGED_EDITS) {
+            m_editLogBase = m_editLog.front().version;
+            while (!m_editLog.empty() && m_editLog.front().version == m_editLogBase) {
+                m_editLog.pop_front();
+            }
         }
     }
+
+    recalculatePath();
 }
 
 void Application::handleKeyPress(sf::Keyboard::Key key) {
@@ -139,7 +542,8 @@ void Application::handleKeyPress(sf::Keyboard::Key key) {
         break;
 
     case sf::Keyboard::Escape:
-        m_window.close();
+        // The window belongs to the render thread, which closes it
+        m_quitRequested.store(true);
         break;
 
     default:
@@ -147,6 +551,19 @@ void Application::handleKeyPress(sf::Keyboard::Key key) {
     }
 }
 
+std::vector<Vec2i> Application::findPathTimed(const Vec2i& start, const Vec2i& end) {
+    auto searchStart = std::chrono::steady_clock::now();
+
+    std::vector<Vec2i> path = m_pathfinder.findPath(m_grid, start, end);
+
+    std::chrono::duration<double> searchTime = std::chrono::steady_clock::now() - searchStart;
+    m_stats.searches++;
+    m_stats.nodesExpanded += m_pathfinder.getLastSearchStats().nodesExpanded;
+    m_stats.totalSearchSeconds += searchTime.count();
+
+    return path;
+}
+
 void Application::recalculatePath() {
     auto startPos = m_grid.getStartPosition();
     auto endPos = m_grid.getEndPosition();
@@ -154,11 +571,11 @@ void Application::recalculatePath() {
     if (!startPos || !endPos) {
         m_currentPath.clear();
         m_agent.reset();
-        m_needsRebuild = true;
+        m_pathVersion++;
         return;
     }
 
-    m_currentPath = m_pathfinder.findPath(m_grid, *startPos, *endPos);
+    m_currentPath = findPathTimed(*startPos, *endPos);
 
     if (!m_currentPath.empty()) {
         m_agent.setPath(m_currentPath);
@@ -167,13 +584,13 @@ void Application::recalculatePath() {
         m_agent.reset();
     }
 
-    m_needsRebuild = true;
+    m_pathVersion++;
 }
 
 void Application::navigateTo(const Vec2i& destination) {
     Vec2i origin = getAgentOrigin();
 
-    m_currentPath = m_pathfinder.findPath(m_grid, origin, destination);
+    m_currentPath = findPathTimed(origin, destination);
 
     if (!m_currentPath.empty()) {
         m_agent.setPath(m_currentPath);
@@ -182,7 +599,7 @@ void Application::navigateTo(const Vec2i& destination) {
         m_agent.reset();
     }
 
-    m_needsRebuild = true;
+    m_pathVersion++;
 }
 
 Vec2i Application::getAgentOrigin() const {
@@ -202,73 +619,277 @@ Vec2i Application::getAgentOrigin() const {
     return { 0, 0 };
 }
 
-void Application::update() {
-    float deltaTime = m_deltaClock.restart().asSeconds();
+void Application::update(float deltaTime) {
     m_agent.update(deltaTime);
+    m_recorder.endFrame(deltaTime);
+}
+
+void Application::publishSnapshot() {
+    RenderSnapshot& snapshot = m_snapshots.back();
+
+    // Slots are reused, so only refresh what moved on since this one was
+    // written. The whole grid is copied only on load or resize, or if the
+    // slot is older than the edit log reaches back.
+    const bool resized = snapshot.cells.empty()
+        || snapshot.gridWidth != m_grid.getWidth() || snapshot.gridHeight != m_grid.getHeight();
+
+    if (resized || snapshot.gridVersion < m_editLogBase) {
+        snapshot.gridWidth = m_grid.getWidth();
+        snapshot.gridHeight = m_grid.getHeight();
+        snapshot.cells.resize(static_cast<size_t>(snapshot.gridWidth) * snapshot.gridHeight);
+
+        size_t index = 0;
+        for (int y = 0; y < snapshot.gridHeight; ++y) {
+            for (int x = 0; x < snapshot.gridWidth; ++x) {
+                snapshot.cells[index++] = m_grid.getCellType({ x, y });
+            }
+        }
+    }
+    else if (snapshot.gridVersion != m_grid.getVersion()) {
+        for (const CellEdit& edit : m_editLog) {
+            if (edit.version > snapshot.gridVersion) {
+                snapshot.cells[static_cast<size_t>(edit.pos.y) * snapshot.gridWidth + edit.pos.x] = m_grid.getCellType(edit.pos);
+            }
+        }
+    }
+
+    if (resized || snapshot.gridVersion != m_grid.getVersion()) {
+        snapshot.gridVersion = m_grid.getVersion();
+        snapshot.editsSinceVersion = m_editLogBase;
+        snapshot.recentEdits.assign(m_editLog.begin(), m_editLog.end());
+    }
+
+    snapshot.startPosition = m_grid.getStartPosition();
+    snapshot.endPosition = m_grid.getEndPosition();
+
+    if (snapshot.pathVersion != m_pathVersion) {
+        snapshot.pathVersion = m_pathVersion;
+        snapshot.path = m_currentPath;
+    }
+
+    // Continuous position part way into the next cell, so the renderer can
+    // interpolate between two ticks without the agent jumping cell to cell
+    auto pos = m_agent.getPosition();
+    auto next = m_agent.getNextPosition();
+    snapshot.hasAgent = pos.has_value();
+
+    if (pos && next) {
+        float progress = m_agent.getMoveProgress();
+        sf::Vector2f current(pos->x + (next->x - pos->x) * progress, pos->y + (next->y - pos->y) * progress);
+
+        // A new path restarts the agent, and a new agent has nowhere to
+        // come from; either way it starts still instead of sliding across
+        if (!m_lastAgentPosition || m_lastAgentPathVersion != m_pathVersion) {
+            m_lastAgentPosition = current;
+        }
+
+        snapshot.previousAgentPosition = *m_lastAgentPosition;
+        snapshot.agentPosition = current;
+        m_lastAgentPosition = current;
+        m_lastAgentPathVersion = m_pathVersion;
+    }
+    else {
+        m_lastAgentPosition.reset();
+    }
+
+    snapshot.mode = m_currentMode;
+    snapshot.allowDiagonal = m_pathfinder.getAllowDiagonal();
+    snapshot.publishTime = std::chrono::steady_clock::now();
+
+    m_snapshots.publish();
 }
 
 void Application::render() {
-    if (m_needsRebuild) {
-        rebuildVertices();
-        m_needsRebuild = false;
+    const RenderSnapshot& snapshot = m_snapshots.acquire();
+
+    // Geometry only covers what the camera sees, so it's rebuilt whenever
+    // the view moves. Its size follows the screen, never the map. Edits
+    // just recolor the quads they fall in.
+    const unsigned long long renderedGridVersion = m_renderedGridVersion;
+    const GridSync sync = syncGridState(snapshot);
+    const bool gridChanged = sync != GridSync::Unchanged;
+    const VisibleBlocks visible = getVisibleBlocks();
+    const bool viewChanged = visible != m_renderedBlocks;
+
+    if (sync == GridSync::Rebuilt || viewChanged) {
+        buildGridVertices(snapshot, visible);
+    }
+    else if (sync == GridSync::Patched) {
+        patchGridVertices(snapshot, visible, renderedGridVersion);
     }
+    if (snapshot.pathVersion != m_renderedPathVersion || gridChanged || viewChanged) {
+        buildPathVertices(snapshot, visible);
+    }
+    m_renderedBlocks = visible;
 
     m_window.clear();
 
+    m_window.setView(m_camera.getView(m_window.getSize()));
     m_window.draw(m_gridVertices);
     m_window.draw(m_pathVertices);
+    renderAgent(snapshot);
 
-    renderAgent();
-    renderHUD();
+    // The HUD is laid out in window pixels
+    sf::Vector2f windowSize(static_cast<float>(m_window.getSize().x), static_cast<float>(m_window.getSize().y));
+    m_window.setView(sf::View(sf::FloatRect(0.0f, 0.0f, windowSize.x, windowSize.y)));
+    renderHUD(snapshot);
 
     m_window.display();
 }
 
-void Application::rebuildVertices() {
-    const int width = m_grid.getWidth();
-    const int height = m_grid.getHeight();
+GridSync Application::syncGridState(const RenderSnapshot& snapshot) {
+    const bool resized = m_mipmap.getLevelCount() == 0
+        || m_mipmap.getLevelSize(0) != Vec2i(snapshot.gridWidth, snapshot.gridHeight);
+
+    if (!resized && snapshot.gridVersion == m_renderedGridVersion) {
+        return GridSync::Unchanged;
+    }
+
+    // Catch up from the snapshot's edit list when it reaches back far
+    // enough; only the first frame, a resize or a long stall rebuilds
+    GridSync sync = GridSync::Patched;
+    if (resized || snapshot.editsSinceVersion > m_renderedGridVersion) {
+        m_mipmap.build(snapshot.cells, snapshot.gridWidth, snapshot.gridHeight);
+        sync = GridSync::Rebuilt;
+    }
+    else {
+        for (const CellEdit& edit : snapshot.recentEdits) {
+            if (edit.version > m_renderedGridVersion) {
+                CellType type = snapshot.cells[static_cast<size_t>(edit.pos.y) * snapshot.gridWidth + edit.pos.x];
+                m_mipmap.setObstacle(edit.pos, type == CellType::Obstacle);
+            }
+        }
+    }
+
+    m_renderedGridVersion = snapshot.gridVersion;
+    return sync;
+}
+
+VisibleBlocks Application::getVisibleBlocks() const {
+    VisibleBlocks visible;
+    visible.level = 0;
 
+    const float cellPixels = m_cellSize / m_camera.getZoom();
+    while (visible.level + 1 < m_mipmap.getLevelCount()
+        && cellPixels * static_cast<float>(1 << visible.level) < Config::MIN_BLOCK_PIXELS) {
+        ++visible.level;
+    }
+
+    const float blockSize = m_cellSize * static_cast<float>(1 << visible.level);
+    const Vec2i levelSize = m_mipmap.getLevelSize(visible.level);
+    const sf::FloatRect rect = m_camera.getVisibleRect();
+
+    auto toBlock = [&](float world, int limit, bool roundUp) {
+        float block = roundUp ? std::ceil(world / blockSize) : std::floor(world / blockSize);
+        return static_cast<int>(std::max(0.0f, std::min(block, static_cast<float>(limit))));
+    };
+
+    visible.min = { toBlock(rect.left, levelSize.x, false), toBlock(rect.top, levelSize.y, false) };
+    visible.max = { toBlock(rect.left + rect.width, levelSize.x, true), toBlock(rect.top + rect.height, levelSize.y, true) };
+    return visible;
+}
+
+void Application::buildGridVertices(const RenderSnapshot& snapshot, const VisibleBlocks& visible) {
     m_gridVertices.clear();
-    m_gridVertices.resize(static_cast<size_t>(width * height * 4));
 
-    size_t vertexIndex = 0;
+    for (int y = visible.min.y; y < visible.max.y; ++y) {
+        for (int x = visible.min.x; x < visible.max.x; ++x) {
+            sf::Color color = visible.level == 0
+                ? getCellColor(snapshot.cells[static_cast<size_t>(y) * snapshot.gridWidth + x])
+                : getBlockColor(visible.level, { x, y });
 
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            Vec2i pos = { x, y };
-            sf::Color color = getCellColor(m_grid.getCellType(pos));
+            appendBlock(m_gridVertices, snapshot, visible.level, { x, y }, color);
+        }
+    }
+}
 
-            float left = x * m_cellSize;
-            float top = y * m_cellSize;
-            float right = left + m_cellSize - 1.0f;
-            float bottom = top + m_cellSize - 1.0f;
+void Application::patchGridVertices(const RenderSnapshot& snapshot, const VisibleBlocks& visible,
+    unsigned long long sinceVersion)
+{
+    // Quads were appended row by row over the visible blocks
+    const int rowLength = visible.max.x - visible.min.x;
 
-            m_gridVertices[vertexIndex + 0] = sf::Vertex({ left,  top }, color);
-            m_gridVertices[vertexIndex + 1] = sf::Vertex({ right, top }, color);
-            m_gridVertices[vertexIndex + 2] = sf::Vertex({ right, bottom }, color);
-            m_gridVertices[vertexIndex + 3] = sf::Vertex({ left,  bottom }, color);
+    for (const CellEdit& edit : snapshot.recentEdits) {
+        if (edit.version <= sinceVersion) {
+            continue;
+        }
 
-            vertexIndex += 4;
+        Vec2i block = { edit.pos.x >> visible.level, edit.pos.y >> visible.level };
+        if (block.x < visible.min.x || block.x >= visible.max.x
+            || block.y < visible.min.y || block.y >= visible.max.y) {
+            continue;
+        }
+
+        sf::Color color = visible.level == 0
+            ? getCellColor(snapshot.cells[static_cast<size_t>(edit.pos.y) * snapshot.gridWidth + edit.pos.x])
+            : getBlockColor(visible.level, block);
+
+        const size_t first = (static_cast<size_t>(block.y - visible.min.y) * rowLength + (block.x - visible.min.x)) * 4;
+        for (size_t i = first; i < first + 4; ++i) {
+            m_gridVertices[i].color = color;
         }
     }
+}
 
+void Application::buildPathVertices(const RenderSnapshot& snapshot, const VisibleBlocks& visible) {
     m_pathVertices.clear();
 
-    for (const Vec2i& pos : m_currentPath) {
-        CellType type = m_grid.getCellType(pos);
+    auto isVisible = [&](const Vec2i& block) {
+        return block.x >= visible.min.x && block.x < visible.max.x
+            && block.y >= visible.min.y && block.y < visible.max.y;
+    };
+
+    // Consecutive path cells mostly share a block once zoomed out
+    Vec2i lastBlock = { -1, -1 };
+
+    for (const Vec2i& pos : snapshot.path) {
+        CellType type = snapshot.cells[static_cast<size_t>(pos.y) * snapshot.gridWidth + pos.x];
         if (type == CellType::Start || type == CellType::End) {
             continue;
         }
 
-        appendQuad(m_pathVertices, pos, Config::PATH_COLOR);
+        Vec2i block = { pos.x >> visible.level, pos.y >> visible.level };
+        if (block == lastBlock || !isVisible(block)) {
+            continue;
+        }
+
+        appendBlock(m_pathVertices, snapshot, visible.level, block, Config::PATH_COLOR);
+        lastBlock = block;
     }
+
+    // Start and end would vanish into the aggregate colors, so draw their
+    // blocks on top
+    auto appendMarker = [&](const std::optional<Vec2i>& cell, sf::Color color) {
+        if (!cell) {
+            return;
+        }
+
+        Vec2i block = { cell->x >> visible.level, cell->y >> visible.level };
+        if (isVisible(block)) {
+            appendBlock(m_pathVertices, snapshot, visible.level, block, color);
+        }
+    };
+
+    if (visible.level > 0) {
+        appendMarker(snapshot.startPosition, Config::CELL_START);
+        appendMarker(snapshot.endPosition, Config::CELL_END);
+    }
+
+    m_renderedPathVersion = snapshot.pathVersion;
 }
 
-void Application::appendQuad(sf::VertexArray& vertices, const Vec2i& gridPos, sf::Color color) const {
-    float left = gridPos.x * m_cellSize;
-    float top = gridPos.y * m_cellSize;
-    float right = left + m_cellSize - 1.0f;
-    float bottom = top + m_cellSize - 1.0f;
+void Application::appendBlock(sf::VertexArray& vertices, const RenderSnapshot& snapshot,
+    int level, const Vec2i& block, sf::Color color) const
+{
+    const int blockCells = 1 << level;
+
+    // Edge blocks stop at the grid border. Single cells keep their one-unit
+    // gap as grid lines; merged blocks don't, since it would shimmer.
+    const float gap = level == 0 ? 1.0f : 0.0f;
+    float left = block.x * blockCells * m_cellSize;
+    float top = block.y * blockCells * m_cellSize;
+    float right = std::min((block.x + 1) * blockCells, snapshot.gridWidth) * m_cellSize - gap;
+    float bottom = std::min((block.y + 1) * blockCells, snapshot.gridHeight) * m_cellSize - gap;
 
     vertices.append(sf::Vertex({ left,  top }, color));
     vertices.append(sf::Vertex({ right, top }, color));
@@ -276,30 +897,44 @@ void Application::appendQuad(sf::VertexArray& vertices, const Vec2i& gridPos, sf
     vertices.append(sf::Vertex({ left,  bottom }, color));
 }
 
-void Application::renderAgent() {
-    auto pos = m_agent.getPosition();
-
-    if (!pos) {
+void Application::renderAgent(const RenderSnapshot& snapshot) {
+    if (!snapshot.hasAgent) {
         return;
     }
 
-    float radius = m_cellSize / 3.0f;
+    // Pipelined frames land between ticks: blend from the previous tick's
+    // position towards this one by how far into the tick we are
+    float alpha = 1.0f;
+    if (m_options.pipelined) {
+        std::chrono::duration<float> sincePublish = std::chrono::steady_clock::now() - snapshot.publishTime;
+        alpha = std::min(sincePublish.count() * static_cast<float>(m_options.simulationHz), 1.0f);
+    }
+
+    sf::Vector2f pos = snapshot.previousAgentPosition
+        + (snapshot.agentPosition - snapshot.previousAgentPosition) * alpha;
+
+    // Never shrinks below a few pixels, so it can still be found zoomed out
+    float radius = std::max(m_cellSize / 3.0f, Config::AGENT_MIN_RADIUS_PIXELS * m_camera.getZoom());
+    sf::Vector2f center((pos.x + 0.5f) * m_cellSize, (pos.y + 0.5f) * m_cellSize);
+
+    sf::FloatRect visible = m_camera.getVisibleRect();
+    if (center.x + radius < visible.left || center.x - radius > visible.left + visible.width
+        || center.y + radius < visible.top || center.y - radius > visible.top + visible.height) {
+        return;
+    }
 
     sf::CircleShape agentCircle(radius);
-    agentCircle.setPosition(
-        pos->x * m_cellSize + radius,
-        pos->y * m_cellSize + radius
-    );
+    agentCircle.setPosition(center.x - radius, center.y - radius);
     agentCircle.setFillColor(Config::AGENT_COLOR);
     m_window.draw(agentCircle);
 }
 
-void Application::renderHUD() {
+void Application::renderHUD(const RenderSnapshot& snapshot) {
     if (!m_fontLoaded) {
         return;
     }
 
-    float gridBottom = m_grid.getHeight() * m_cellSize;
+    float gridBottom = m_camera.getViewportSize().y;
     float windowWidth = static_cast<float>(m_window.getSize().x);
 
     sf::RectangleShape hudBackground(sf::Vector2f(windowWidth, static_cast<float>(HUD_HEIGHT)));
@@ -307,32 +942,37 @@ void Application::renderHUD() {
     hudBackground.setFillColor(Config::HUD_BACKGROUND);
     m_window.draw(hudBackground);
 
-    m_hudText.setString(getHUDString());
+    m_hudText.setString(getHUDString(snapshot));
     m_hudText.setPosition(8.0f, gridBottom + 6.0f);
     m_window.draw(m_hudText);
 }
 
-std::string Application::getHUDString() const {
+std::string Application::getHUDString(const RenderSnapshot& snapshot) const {
     std::ostringstream hud;
 
-    hud << "[1] Obstacle  [2] Start  [3] End  [4] Navigate  |  Mode: " << getModeName()
-        << "  |  [D] Diagonal: " << (m_pathfinder.getAllowDiagonal() ? "ON" : "OFF")
+    hud << "[1] Obstacle  [2] Start  [3] End  [4] Navigate  |  Mode: " << getModeName(snapshot.mode)
+        << "  |  [D] Diagonal: " << (snapshot.allowDiagonal ? "ON" : "OFF")
         << "  |  ";
 
-    if (m_currentPath.empty()) {
+    if (snapshot.path.empty()) {
         hud << "No path";
     }
     else {
-        hud << "Path: " << m_currentPath.size() << " nodes";
+        hud << "Path: " << snapshot.path.size() << " nodes";
     }
 
-    hud << "\n[Space] Recalculate  [RMB] Remove  [Esc] Quit";
+    hud << "\n[Space] Recalculate  [RMB] Remove  [Wheel] Zoom  [MMB/Arrows] Pan  [F] Fit  [Esc] Quit"
+        << "  |  Zoom: " << static_cast<int>(100.0f / m_camera.getZoom() + 0.5f) << "%";
+
+    if (m_renderedBlocks.level > 0) {
+        hud << " (" << (1 << m_renderedBlocks.level) << "x" << (1 << m_renderedBlocks.level) << " blocks)";
+    }
 
     return hud.str();
 }
 
-std::string Application::getModeName() const {
-    switch (m_currentMode) {
+std::string Application::getModeName(PlacementMode mode) const {
+    switch (mode) {
     case PlacementMode::Obstacle: return "Obstacle";
     case PlacementMode::Start:    return "Start";
     case PlacementMode::End:      return "End";
@@ -349,4 +989,21 @@ sf::Color Application::getCellColor(CellType type) const {
     case CellType::End:       return Config::CELL_END;
     default:                  return Config::CELL_DEFAULT;
     }
+}
+
+sf::Color Application::getBlockColor(int level, const Vec2i& block) const {
+    return blend(Config::CELL_WALKABLE, Config::CELL_OBSTACLE, m_mipmap.getObstacleShare(level, block));
+}
+
+void Application::printSessionStats() const {
+    double avgFrameMs = m_stats.frames > 0
+        ? m_stats.totalFrameSeconds * 1000.0 / m_stats.frames
+        : 0.0;
+
+    std::cout << "frames:              " << m_stats.frames << '\n'
+              << "frame time avg (ms): " << avgFrameMs << '\n'
+              << "frame time max (ms): " << m_stats.maxFrameSeconds * 1000.0 << '\n'
+              << "searches:            " << m_stats.searches << '\n'
+              << "nodes expanded:      " << m_stats.nodesExpanded << '\n'
+              << "search time (ms):    " << m_stats.totalSearchSeconds * 1000.0 << '\n';
 }
\ No newline at end of file
@@ -3,9 +3,19 @@
 #include "Grid.h"
 #include "Pathfinder.h"
 #include "Agent.h"
+#include "Camera.h"
+#include "GridMipmap.h"
+#include "InputLog.h"
+#include "SnapshotBuffer.h"
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <sstream>
+#include <thread>
 
 enum class PlacementMode {
     Obstacle,
@@ -14,9 +24,102 @@ enum class PlacementMode {
     Navigate
 };
 
+enum class SessionMode {
+    Interactive,
+    Record,     // Interactive, with all input written to the input log
+    Replay      // Input and frame deltas read back from the input log
+};
+
+struct SessionOptions {
+    SessionMode mode = SessionMode::Interactive;
+    std::string inputLogPath;
+
+    // Replay only: never create the window and skip rendering entirely
+    bool headless = false;
+
+    // Interactive only: run the simulation on its own fixed-timestep thread
+    // and let the render thread draw the latest published snapshot
+    bool pipelined = false;
+    int simulationHz = 60;
+};
+
+// Frame and search timings, printed when a session ends so runs can be diffed
+struct SessionStats {
+    int frames = 0;
+    double totalFrameSeconds = 0.0;
+    double maxFrameSeconds = 0.0;
+
+    int searches = 0;
+    long long nodesExpanded = 0;
+    double totalSearchSeconds = 0.0;
+};
+
+// One cell whose type changed in a committed grid version
+struct CellEdit {
+    unsigned long long version;
+    Vec2i pos;
+};
+
+// Everything the renderer needs from one simulation tick. Snapshots are
+// published through a SnapshotBuffer and never modified while the renderer
+// holds one. Cells and path are only recopied into a slot when their
+// version has moved on since that slot was last written.
+struct RenderSnapshot {
+    std::chrono::steady_clock::time_point publishTime;
+
+    int gridWidth = 0;
+    int gridHeight = 0;
+    unsigned long long gridVersion = 0;
+    std::vector<CellType> cells;
+
+    // Cells edited in every grid version after editsSinceVersion, oldest
+    // first, so a reader holding an older version can catch up without
+    // rescanning the grid. Readers further behind resync from 'cells'.
+    unsigned long long editsSinceVersion = 0;
+    std::vector<CellEdit> recentEdits;
+
+    std::optional<Vec2i> startPosition;
+    std::optional<Vec2i> endPosition;
+
+    unsigned long long pathVersion = 0;
+    std::vector<Vec2i> path;
+
+    // Agent position in cell units, at this tick and the one before it
+    bool hasAgent = false;
+    sf::Vector2f agentPosition;
+    sf::Vector2f previousAgentPosition;
+
+    PlacementMode mode = PlacementMode::Obstacle;
+    bool allowDiagonal = false;
+};
+
+// What syncGridState had to do to catch the mipmap up with a snapshot
+enum class GridSync {
+    Unchanged,
+    Patched,    // Only the snapshot's edited cells changed
+    Rebuilt     // First frame, resize, or too far behind the edit list
+};
+
+// Blocks of one mipmap level that overlap the camera's view; level 0
+// blocks are single cells
+struct VisibleBlocks {
+    int level = -1;
+    Vec2i min;      // Inclusive
+    Vec2i max;      // Exclusive
+
+    bool operator==(const VisibleBlocks& other) const {
+        return level == other.level && min == other.min && max == other.max;
+    }
+
+    bool operator!=(const VisibleBlocks& other) const {
+        return !(*this == other);
+    }
+};
+
 class Application {
 public:
-    Application(int gridWidth, int gridHeight, int cellSize);
+    Application(int gridWidth, int gridHeight, int cellSize,
+        const SessionOptions& options = SessionOptions());
 
     void run();
 
@@ -25,17 +128,60 @@ private:
     Pathfinder m_pathfinder;
     Agent m_agent;
 
+    SessionOptions m_options;
+    InputRecorder m_recorder;
+    InputPlayer m_player;
+    SessionStats m_stats;
+
     sf::RenderWindow m_window;
     float m_cellSize;
 
     PlacementMode m_currentMode;
     std::vector<Vec2i> m_currentPath;
     sf::Clock m_deltaClock;
+    unsigned long long m_pathVersion;
+
+    // Simulation to render hand-off. The renderer only ever reads snapshots.
+    SnapshotBuffer<RenderSnapshot> m_snapshots;
+
+    // Agent position last published, and the path it was on. Empty while
+    // there is no agent.
+    std::optional<sf::Vector2f> m_lastAgentPosition;
+    unsigned long long m_lastAgentPathVersion;
+
+    // Recent grid edits, oldest first, covering every version after
+    // m_editLogBase. Snapshots are patched from it instead of recopied.
+    std::deque<CellEdit> m_editLog;
+    unsigned long long m_editLogBase;
+    static constexpr size_t MAX_LOGGED_EDITS = 4096;
 
-    // Pre-built vertex arrays  rebuilt only when the grid or path changes
+    // Pipelined mode: input forwarded from the render thread to the simulation
+    std::thread m_simulationThread;
+    std::atomic<bool> m_stopSimulation;
+    std::mutex m_inputMutex;
+    std::vector<InputEvent> m_pendingInput;
+
+    // Set by the quit key on whichever thread handles input
+    std::atomic<bool> m_quitRequested;
+
+    // Render thread only: view over the grid, and its zoomed-out aggregate
+    Camera m_camera;
+    GridMipmap m_mipmap;
+    bool m_isPanning;
+    sf::Vector2f m_lastPanPixel;
+
+    // Geometry for the visible blocks only  rebuilt when the view, or the
+    // snapshot's grid or path, changes
     sf::VertexArray m_gridVertices;
     sf::VertexArray m_pathVertices;
-    bool m_needsRebuild;
+    VisibleBlocks m_renderedBlocks;
+    unsigned long long m_renderedGridVersion;
+    unsigned long long m_renderedPathVersion;
+
+    // Click-drag painting: the held button and the last cell it painted
+    bool m_isDragging;
+    bool m_dragIsLeft;
+    Vec2i m_lastDragCell;
 
     // HUD
     static constexpr int HUD_HEIGHT = 48;
@@ -43,13 +189,37 @@ private:
     sf::Text m_hudText;
     bool m_fontLoaded;
 
+    void runInteractive();
+    void runPipelined();
+    void runReplay();
+
+    // Pipelined mode: fixed-timestep loop run on m_simulationThread
+    void simulationLoop();
+
     void handleEvents();
-    void update();
+
+    // Pan and zoom input, handled on the render thread and never recorded.
+    // Returns true if the event was used.
+    bool handleCameraEvent(const sf::Event& event);
+
+    // Maps a window pixel to the cell under it; false over the HUD
+    bool screenToCell(int x, int y, Vec2i& cell) const;
+    void update(float deltaTime);
     void render();
 
+    // Hands input to the simulation: directly, or via the queue when pipelined
+    void submitInput(const InputEvent& event);
+
+    // Records the input when recording, then routes it to the matching handler
+    void dispatchInput(const InputEvent& event);
+
     void handleMouseClick(const Vec2i& gridPos, bool isLeftClick);
+    void handleMouseDrag(const Vec2i& gridPos, bool isLeftClick);
     void handleKeyPress(sf::Keyboard::Key key);
 
+    // findPath wrapper that feeds the session stats
+    std::vector<Vec2i> findPathTimed(const Vec2i& start, const Vec2i& end);
+
     // Pathfinds between grid start/end markers
     void recalculatePath();
 
@@ -59,14 +229,39 @@ private:
     // Returns the agent's current grid position, falling back to the grid start
     Vec2i getAgentOrigin() const;
 
-    void rebuildVertices();
-    void appendQuad(sf::VertexArray& vertices, const Vec2i& gridPos, sf::Color color) const;
+    // Left paints an obstacle, right erases one
+    void paintCell(const Vec2i& gridPos, bool isLeftClick);
+
+    // Called once per committed grid edit with every changed cell
+    void onGridChanged(const GridChangeSet& changes);
+
+    // Copies the current simulation state into the next snapshot and publishes it
+    void publishSnapshot();
+
+    // Applies the snapshot's cell edits to the mipmap
+    GridSync syncGridState(const RenderSnapshot& snapshot);
+
+    // Coarsest level whose blocks still cover MIN_BLOCK_PIXELS on screen,
+    // and which of its blocks are in view
+    VisibleBlocks getVisibleBlocks() const;
+
+    void buildGridVertices(const RenderSnapshot& snapshot, const VisibleBlocks& visible);
+
+    // Recolors the quads of blocks holding cells edited after sinceVersion,
+    // in place, when the visible blocks haven't changed since the last build
+    void patchGridVertices(const RenderSnapshot& snapshot, const VisibleBlocks& visible,
+        unsigned long long sinceVersion);
+    void buildPathVertices(const RenderSnapshot& snapshot, const VisibleBlocks& visible);
+    void appendBlock(sf::VertexArray& vertices, const RenderSnapshot& snapshot,
+        int level, const Vec2i& block, sf::Color color) const;
 
-    void renderAgent();
-    void renderHUD();
-    std::string getHUDString() const;
-    std::string getModeName() const;
+    void renderAgent(const RenderSnapshot& snapshot);
+    void renderHUD(const RenderSnapshot& snapshot);
+    std::string getHUDString(const RenderSnapshot& snapshot) const;
+    std::string getModeName(PlacementMode mode) const;
     sf::Color getCellColor(CellType type) const;
+    sf::Color getBlockColor(int level, const Vec2i& block) const;
 
     bool loadFont();
+    void printSessionStats() const;
 };
\ No newline at end of file
@@ -0,0 +1,410 @@
+#include "Benchmark.h"
+#include "CooperativePlanner.h"
+#include "DistanceMap.h"
+#include "FirstMoveTable.h"
+#include "Grid.h"
+#include "Movement.h"
+#include "Pathfinder.h"
+#include "SubgoalGraph.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace {
+
+    using BenchmarkClock = std::chrono::steady_clock;
+
+    struct Query {
+        Vec2i start;
+        Vec2i end;
+        int optimalCost;
+        int optimalExpansions;
+    };
+
+    struct ModeResult {
+        long long expansions = 0;
+        double seconds = 0.0;
+        double costRatioSum = 0.0;
+        double maxCostRatio = 0.0;
+        int failures = 0;
+        int boundViolations = 0;
+    };
+
+    const char* modeName(SearchMode mode) {
+        switch (mode) {
+        case SearchMode::Optimal:         return "optimal";
+        case SearchMode::Weighted:        return "weighted";
+        case SearchMode::DynamicWeighted: return "dynamic";
+        case SearchMode::Focal:           return "focal";
+        case SearchMode::TableLookup:     return "table";
+        case SearchMode::Subgoal:         return "subgoal";
+        }
+        return "?";
+    }
+
+    Vec2i randomWalkableCell(const Grid& grid, std::mt19937& rng) {
+        std::uniform_int_distribution<int> randomX(0, grid.getWidth() - 1);
+        std::uniform_int_distribution<int> randomY(0, grid.getHeight() - 1);
+
+        while (true) {
+            Vec2i pos = { randomX(rng), randomY(rng) };
+            if (grid.isWalkable(pos)) {
+                return pos;
+            }
+        }
+    }
+
+    void printRow(SearchMode mode, float epsilon, const ModeResult& result,
+        size_t queryCount, double optimalExpansions)
+    {
+        double count = static_cast<double>(queryCount);
+        double expansions = result.expansions / count;
+
+        std::cout << std::left << std::setw(10) << modeName(mode)
+                  << std::right << std::setw(8) << epsilon
+                  << std::setw(14) << expansions
+                  << std::setw(10) << (optimalExpansions > 0.0 ? expansions / optimalExpansions : 0.0)
+                  << std::setw(12) << result.seconds * 1e6 / count
+                  << std::setw(11) << result.costRatioSum / count
+                  << std::setw(11) << result.maxCostRatio
+                  << std::setw(9) << result.boundViolations + result.failures << '\n';
+    }
+
+} // anonymous namespace
+
+Benchmark::Benchmark(const BenchmarkOptions& options)
+    : m_options(options)
+{
+}
+
+void Benchmark::run() {
+    const int width = std::max(m_options.width, 2);
+    const int height = std::max(m_options.height, 2);
+
+    std::mt19937 rng(m_options.seed);
+    std::uniform_int_distribution<int> randomPercent(0, 99);
+
+    Grid grid(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (randomPercent(rng) < m_options.obstaclePercent) {
+                grid.setCellType({ x, y }, CellType::Obstacle);
+            }
+        }
+    }
+
+    Pathfinder pathfinder;
+    pathfinder.setAllowDiagonal(m_options.allowDiagonal);
+
+    // Optimal costs first; unreachable pairs are redrawn so every mode is
+    // measured on the same set of solvable queries
+    std::vector<Query> queries;
+    ModeResult optimal;
+    int attempts = 0;
+    const int maxAttempts = std::max(m_options.queries, 1) * 100;
+
+    while (static_cast<int>(queries.size()) < m_options.queries && attempts++ < maxAttempts) {
+        Vec2i start = randomWalkableCell(grid, rng);
+        Vec2i end = randomWalkableCell(grid, rng);
+
+        auto searchStart = BenchmarkClock::now();
+        std::vector<Vec2i> path = pathfinder.findPath(grid, start, end);
+        std::chrono::duration<double> elapsed = BenchmarkClock::now() - searchStart;
+
+        if (path.empty()) {
+            continue;
+        }
+
+        int expansions = pathfinder.getLastSearchStats().nodesExpanded;
+        queries.push_back({ start, end, Movement::pathCost(path), expansions });
+
+        optimal.expansions += expansions;
+        optimal.seconds += elapsed.count();
+        optimal.costRatioSum += 1.0;
+        optimal.maxCostRatio = 1.0;
+    }
+
+    if (queries.empty()) {
+        std::cerr << "Error: No reachable queries on the benchmark grid.\n";
+        return;
+    }
+
+    const double optimalExpansions = optimal.expansions / static_cast<double>(queries.size());
+
+    std::cout << "grid:      " << width << "x" << height << ", " << m_options.obstaclePercent
+              << "% obstacles, " << (m_options.allowDiagonal ? "8" : "4") << "-connected\n"
+              << "queries:   " << queries.size() << "\n\n"
+              << std::fixed << std::setprecision(2)
+              << std::left << std::setw(10) << "mode"
+              << std::right << std::setw(8) << "epsilon"
+              << std::setw(14) << "expansions"
+              << std::setw(10) << "vs A*"
+              << std::setw(12) << "time (us)"
+              << std::setw(11) << "cost avg"
+              << std::setw(11) << "cost max"
+              << std::setw(9) << "errors" << '\n';
+
+    printRow(SearchMode::Optimal, 0.0f, optimal, queries.size(), optimalExpansions);
+
+    FirstMoveTable table;
+    table.setAllowDiagonal(m_options.allowDiagonal);
+    ThreadPool pool;
+
+    std::vector<std::pair<SearchMode, float>> runs;
+    for (SearchMode mode : { SearchMode::Weighted, SearchMode::DynamicWeighted, SearchMode::Focal }) {
+        for (float epsilon : m_options.epsilons) {
+            runs.push_back({ mode, epsilon });
+        }
+    }
+
+    if (m_options.firstMoveTable && table.build(grid, pool)) {
+        runs.push_back({ SearchMode::TableLookup, 0.0f });
+    }
+
+    SubgoalGraph subgoals;
+    if (m_options.subgoalGraph && m_options.allowDiagonal) {
+        subgoals.build(grid);
+        runs.push_back({ SearchMode::Subgoal, 0.0f });
+    }
+    double subgoalSeconds = 0.0;
+
+    for (const auto& run : runs) {
+        const SearchMode mode = run.first;
+        const float epsilon = run.second;
+
+        SearchOptions searchOptions;
+        searchOptions.mode = mode;
+        searchOptions.epsilon = epsilon;
+        searchOptions.firstMoveTable = &table;
+        searchOptions.subgoalGraph = &subgoals;
+
+        ModeResult result;
+
+        for (const Query& query : queries) {
+            auto searchStart = BenchmarkClock::now();
+            std::vector<Vec2i> path = pathfinder.findPath(grid, query.start, query.end, searchOptions);
+            std::chrono::duration<double> elapsed = BenchmarkClock::now() - searchStart;
+
+            result.expansions += pathfinder.getLastSearchStats().nodesExpanded;
+            result.seconds += elapsed.count();
+
+            if (path.empty()) {
+                ++result.failures;
+                continue;
+            }
+
+            int cost = Movement::pathCost(path);
+            double ratio = query.optimalCost > 0 ? cost / static_cast<double>(query.optimalCost) : 1.0;
+            result.costRatioSum += ratio;
+            result.maxCostRatio = std::max(result.maxCostRatio, ratio);
+
+            if (cost > (1.0 + epsilon) * query.optimalCost) {
+                ++result.boundViolations;
+            }
+        }
+
+        printRow(mode, epsilon, result, queries.size(), optimalExpansions);
+
+        if (result.boundViolations > 0) {
+            std::cerr << "Error: " << result.boundViolations << ' ' << modeName(mode)
+                      << " paths cost more than (1 + " << epsilon << ") times optimal.\n";
+        }
+
+        if (mode == SearchMode::Subgoal) {
+            subgoalSeconds = result.seconds;
+        }
+    }
+
+    if (subgoals.isBuilt()) {
+        std::cout << "\nsubgoal graph\n"
+                  << "build time (s):     " << subgoals.getBuildSeconds() << '\n'
+                  << "subgoals:           " << subgoals.getSubgoalCount() << " of "
+                  << width * height << " cells\n"
+                  << "edges:              " << subgoals.getEdgeCount() << '\n'
+                  << "size (MB):          " << subgoals.getMemoryBytes() / (1024.0 * 1024.0) << '\n'
+                  << "speedup vs A*:      " << (subgoalSeconds > 0.0 ? optimal.seconds / subgoalSeconds : 0.0) << "x\n";
+    }
+    else if (m_options.subgoalGraph) {
+        std::cout << "\nsubgoal graph skipped: it needs diagonal movement\n";
+    }
+
+    if (table.isBuilt()) {
+        // A plain table would store one 3-bit move per (source, target) pair
+        const double sources = static_cast<double>(table.getSourceCount());
+        const double denseBytes = sources * sources * 3.0 / 8.0;
+
+        std::cout << "\nfirst-move table\n"
+                  << "build time (s):     " << table.getBuildSeconds() << " on " << pool.getWorkerCount() << " worker(s)\n"
+                  << "sources:            " << table.getSourceCount() << '\n'
+                  << "runs:               " << table.getRunCount() << " (" << table.getRunCount() / std::max(sources, 1.0)
+                  << " per row)\n"
+                  << "size (MB):          " << table.getMemoryBytes() / (1024.0 * 1024.0)
+                  << " vs " << denseBytes / (1024.0 * 1024.0) << " uncompressed\n";
+    }
+
+    if (m_options.agents > 0) {
+        runCooperative(grid, rng);
+    }
+
+    if (m_options.distanceMaps) {
+        runDistanceMaps(grid, rng);
+    }
+}
+
+void Benchmark::runDistanceMaps(const Grid& grid, std::mt19937& rng) const {
+    const Vec2i source = randomWalkableCell(grid, rng);
+
+    DistanceMap sequential;
+    sequential.setAllowDiagonal(m_options.allowDiagonal);
+
+    auto sequentialStart = BenchmarkClock::now();
+    sequential.compute(grid, source);
+    std::chrono::duration<double> sequentialTime = BenchmarkClock::now() - sequentialStart;
+
+    std::cout << "\ndistance map from (" << source.x << ", " << source.y << ")\n"
+              << std::left << std::setw(10) << "workers"
+              << std::right << std::setw(12) << "time (ms)"
+              << std::setw(10) << "speedup"
+              << std::setw(12) << "identical" << '\n'
+              << std::left << std::setw(10) << "1"
+              << std::right << std::setw(12) << sequentialTime.count() * 1e3
+              << std::setw(10) << 1.0
+              << std::setw(12) << "-" << '\n';
+
+    // Powers of two up to the hardware, and the hardware count itself.
+    // Two workers run even on one core, so the comparison is always made.
+    const unsigned hardware = std::max(std::thread::hardware_concurrency(), 2u);
+    std::vector<unsigned> workerCounts;
+    for (unsigned workers = 2; workers < hardware; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(hardware);
+
+    for (unsigned workers : workerCounts) {
+        ThreadPool pool(workers);
+        DistanceMap parallel;
+        parallel.setAllowDiagonal(m_options.allowDiagonal);
+
+        auto parallelStart = BenchmarkClock::now();
+        parallel.compute(grid, source, &pool);
+        std::chrono::duration<double> parallelTime = BenchmarkClock::now() - parallelStart;
+
+        const bool identical = parallel.getDistances() == sequential.getDistances();
+
+        std::cout << std::left << std::setw(10) << workers
+                  << std::right << std::setw(12) << parallelTime.count() * 1e3
+                  << std::setw(10) << sequentialTime.count() / std::max(parallelTime.count(), 1e-9)
+                  << std::setw(12) << (identical ? "yes" : "NO") << '\n';
+
+        if (!identical) {
+            std::cerr << "Error: Parallel distance map with " << workers
+                      << " workers differs from the sequential one.\n";
+        }
+    }
+}
+
+void Benchmark::runCooperative(const Grid& grid, std::mt19937& rng) const {
+    const int width = grid.getWidth();
+    const int height = grid.getHeight();
+
+    // Starts and goals are each distinct, so every agent can finish
+    std::vector<bool> isStart(static_cast<size_t>(width) * height, false);
+    std::vector<bool> isGoal(isStart.size(), false);
+
+    auto drawCell = [&](std::vector<bool>& taken) {
+        while (true) {
+            Vec2i pos = randomWalkableCell(grid, rng);
+            size_t index = static_cast<size_t>(pos.y) * width + pos.x;
+            if (!taken[index]) {
+                taken[index] = true;
+                return pos;
+            }
+        }
+    };
+
+    int walkableCells = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            walkableCells += grid.isWalkable({ x, y }) ? 1 : 0;
+        }
+    }
+
+    if (m_options.agents > walkableCells) {
+        std::cerr << "Error: More agents than walkable cells.\n";
+        return;
+    }
+
+    CooperativePlanner planner;
+    planner.setAllowDiagonal(m_options.allowDiagonal);
+
+    for (int i = 0; i < m_options.agents; ++i) {
+        Vec2i start = drawCell(isStart);
+        planner.addAgent(start, drawCell(isGoal));
+    }
+
+    auto planStart = BenchmarkClock::now();
+    planner.plan(grid);
+    std::chrono::duration<double> firstPlan = BenchmarkClock::now() - planStart;
+    const SearchStats firstPlanStats = planner.getLastPlanStats();
+
+    // Step until everyone has arrived, or for long enough that the rest
+    // are blocked, checking each step for two agents on one cell or
+    // swapping cells
+    const int maxSteps = 2 * (width + height);
+    std::vector<int> occupant(isStart.size(), -1);
+    std::vector<Vec2i> previous(m_options.agents);
+    int steps = 0;
+    int collisions = 0;
+    int arrived = 0;
+    double stepSeconds = 0.0;
+
+    while (steps < maxSteps && arrived < m_options.agents) {
+        for (int id = 0; id < m_options.agents; ++id) {
+            previous[id] = planner.getPosition(id);
+        }
+
+        auto stepStart = BenchmarkClock::now();
+        planner.step(grid);
+        std::chrono::duration<double> elapsed = BenchmarkClock::now() - stepStart;
+        stepSeconds += elapsed.count();
+        ++steps;
+
+        arrived = 0;
+        for (int id = 0; id < m_options.agents; ++id) {
+            Vec2i pos = planner.getPosition(id);
+            int& other = occupant[static_cast<size_t>(pos.y) * width + pos.x];
+            if (other >= 0) {
+                ++collisions;
+            }
+            other = id;
+            arrived += planner.hasReachedGoal(id) ? 1 : 0;
+        }
+
+        for (int id = 0; id < m_options.agents; ++id) {
+            Vec2i pos = planner.getPosition(id);
+            int other = occupant[static_cast<size_t>(previous[id].y) * width + previous[id].x];
+            if (pos != previous[id] && other > id && previous[other] == pos) {
+                ++collisions;
+            }
+        }
+
+        for (int id = 0; id < m_options.agents; ++id) {
+            Vec2i pos = planner.getPosition(id);
+            occupant[static_cast<size_t>(pos.y) * width + pos.x] = -1;
+        }
+    }
+
+    std::cout << "\ncooperative planner\n"
+              << "agents:             " << m_options.agents << ", window " << planner.getWindow()
+              << ", replanned every " << planner.getReplanInterval() << " steps\n"
+              << "first plan (s):     " << firstPlan.count() << " (" << firstPlanStats.nodesExpanded
+              << " expansions)\n"
+              << "steps:              " << steps << ", " << stepSeconds * 1e3 / std::max(steps, 1)
+              << " ms per step\n"
+              << "arrived:            " << arrived << " of " << m_options.agents << '\n'
+              << "collisions:         " << collisions << '\n';
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <random>
+#include <vector>
+
+class Grid;
+
+struct BenchmarkOptions {
+    int width = 512;
+    int height = 512;
+
+    // Share of cells turned into obstacles at random
+    int obstaclePercent = 25;
+
+    // Reachable start/goal pairs to time every mode on
+    int queries = 200;
+
+    bool allowDiagonal = true;
+    unsigned seed = 1;
+
+    std::vector<float> epsilons = { 0.1f, 0.25f, 0.5f, 1.0f };
+
+    // Also build a first-move table (one Dijkstra per cell, so keep the grid small)
+    bool firstMoveTable = false;
+
+    // Also build a subgoal graph (8-connected only)
+    bool subgoalGraph = false;
+
+    // Also move this many agents to random goals with the cooperative planner
+    int agents = 0;
+
+    // Also time a full distance map, sequential against parallel
+    bool distanceMaps = false;
+};
+
+// Headless comparison of the path search modes on a random grid. Every mode
+// answers the same queries, and each one is reported against optimal A* by
+// node expansions, time and path cost ratio. Optionally builds a
+// first-move table and a subgoal graph and reports their preprocessing
+// time and size as well, and can time the cooperative planner on a crowd
+// of agents, checking every step for collisions, and parallel distance
+// maps against sequential ones, checking that they agree.
+class Benchmark {
+public:
+    explicit Benchmark(const BenchmarkOptions& options);
+
+    void run();
+
+private:
+    BenchmarkOptions m_options;
+
+    void runCooperative(const Grid& grid, std::mt19937& rng) const;
+    void runDistanceMaps(const Grid& grid, std::mt19937& rng) const;
+};
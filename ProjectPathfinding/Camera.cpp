@@ -0,0 +1,71 @@
+#include "Camera.h"
+#include <algorithm>
+
+Camera::Camera()
+    : m_viewportSize(1.0f, 1.0f)
+    , m_worldSize(1.0f, 1.0f)
+    , m_center(0.5f, 0.5f)
+    , m_zoom(1.0f)
+{
+}
+
+void Camera::setViewportSize(const sf::Vector2f& size) {
+    m_viewportSize = { std::max(size.x, 1.0f), std::max(size.y, 1.0f) };
+    m_zoom = std::min(m_zoom, getFitZoom() * MAX_ZOOM_OUT_OF_FIT);
+}
+
+void Camera::setWorldSize(const sf::Vector2f& size) {
+    m_worldSize = { std::max(size.x, 1.0f), std::max(size.y, 1.0f) };
+    clampCenter();
+}
+
+void Camera::fit() {
+    m_zoom = getFitZoom();
+    m_center = { m_worldSize.x / 2.0f, m_worldSize.y / 2.0f };
+}
+
+void Camera::pan(const sf::Vector2f& pixels) {
+    m_center += pixels * m_zoom;
+    clampCenter();
+}
+
+void Camera::zoomAt(const sf::Vector2f& pixel, float factor) {
+    sf::Vector2f anchor = screenToWorld(pixel);
+
+    m_zoom = std::max(1.0f / MAX_MAGNIFICATION,
+        std::min(m_zoom * factor, getFitZoom() * MAX_ZOOM_OUT_OF_FIT));
+
+    // Solve for the center that puts the anchor back under the pixel
+    m_center = anchor - (pixel - m_viewportSize * 0.5f) * m_zoom;
+    clampCenter();
+}
+
+sf::Vector2f Camera::screenToWorld(const sf::Vector2f& pixel) const {
+    return m_center + (pixel - m_viewportSize * 0.5f) * m_zoom;
+}
+
+sf::FloatRect Camera::getVisibleRect() const {
+    sf::Vector2f size = m_viewportSize * m_zoom;
+    return sf::FloatRect(m_center.x - size.x / 2.0f, m_center.y - size.y / 2.0f, size.x, size.y);
+}
+
+sf::View Camera::getView(const sf::Vector2u& windowSize) const {
+    sf::View view;
+    view.setCenter(m_center);
+    view.setSize(m_viewportSize * m_zoom);
+
+    // Only the viewport's share of the window, so the HUD keeps its strip
+    view.setViewport(sf::FloatRect(0.0f, 0.0f,
+        m_viewportSize.x / std::max(static_cast<float>(windowSize.x), 1.0f),
+        m_viewportSize.y / std::max(static_cast<float>(windowSize.y), 1.0f)));
+    return view;
+}
+
+float Camera::getFitZoom() const {
+    return std::max({ m_worldSize.x / m_viewportSize.x, m_worldSize.y / m_viewportSize.y, 1.0f });
+}
+
+void Camera::clampCenter() {
+    m_center.x = std::max(0.0f, std::min(m_center.x, m_worldSize.x));
+    m_center.y = std::max(0.0f, std::min(m_center.y, m_worldSize.y));
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+
+// Pan and zoom over the grid. World coordinates are the grid's pixel
+// coordinates at 1:1 (a cell spans cellSize units); the viewport is the
+// part of the window the grid is drawn into, anchored at its top left.
+class Camera {
+public:
+    Camera();
+
+    void setViewportSize(const sf::Vector2f& size);
+    const sf::Vector2f& getViewportSize() const { return m_viewportSize; }
+
+    // Extent of the grid in world units, used for fitting and clamping
+    void setWorldSize(const sf::Vector2f& size);
+
+    // Shows the whole grid, at 1:1 if it fits
+    void fit();
+
+    // Moves the view by a distance in screen pixels
+    void pan(const sf::Vector2f& pixels);
+
+    // Scales the view by factor (> 1 zooms out), keeping the world point
+    // under the given pixel in place
+    void zoomAt(const sf::Vector2f& pixel, float factor);
+
+    // World units per screen pixel
+    float getZoom() const { return m_zoom; }
+
+    sf::Vector2f screenToWorld(const sf::Vector2f& pixel) const;
+
+    // World-space rectangle currently on screen
+    sf::FloatRect getVisibleRect() const;
+
+    sf::View getView(const sf::Vector2u& windowSize) const;
+
+private:
+    // Most magnified: one world unit covers this many pixels
+    static constexpr float MAX_MAGNIFICATION = 8.0f;
+
+    // How far beyond the fitted view it can zoom out
+    static constexpr float MAX_ZOOM_OUT_OF_FIT = 2.0f;
+
+    sf::Vector2f m_viewportSize;
+    sf::Vector2f m_worldSize;
+    sf::Vector2f m_center;
+    float m_zoom;
+
+    float getFitZoom() const;
+
+    // Keeps the view centered somewhere over the grid
+    void clampCenter();
+};
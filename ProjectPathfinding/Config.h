@@ -16,6 +16,21 @@ namespace Config {
     inline const sf::Color PATH_COLOR = sf::Color::Blue;
     inline const sf::Color AGENT_COLOR = sf::Color::Magenta;
 
+    // Window size cap for the grid area (the HUD goes below it); larger
+    // grids are viewed through the camera
+    inline constexpr unsigned MAX_WINDOW_WIDTH = 1280;
+    inline constexpr unsigned MAX_WINDOW_HEIGHT = 720;
+
+    // Camera controls
+    inline constexpr float ZOOM_STEP = 1.25f;           // Per mouse wheel notch
+    inline constexpr float PAN_STEP_PIXELS = 64.0f;     // Per arrow key press
+
+    // Zoomed out, cells are merged into blocks at least this many pixels across
+    inline constexpr float MIN_BLOCK_PIXELS = 4.0f;
+
+    // The agent stays visible at any zoom
+    inline constexpr float AGENT_MIN_RADIUS_PIXELS = 3.0f;
+
     // HUD colors
     inline const sf::Color HUD_BACKGROUND = sf::Color(30, 30, 30);
     inline const sf::Color HUD_TEXT = sf::Color::White;
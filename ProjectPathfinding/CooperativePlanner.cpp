@@ -0,0 +1,341 @@
+#include "CooperativePlanner.h"
+#include "Movement.h"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <queue>
+
+namespace {
+
+    // Upper bound on cached heuristic search nodes (roughly 100 MB)
+    constexpr size_t HEURISTIC_CACHE_BUDGET = size_t(1) << 20;
+
+    // Full planning passes per window; each retry promotes agents left stuck
+    constexpr int MAX_PLAN_ATTEMPTS = 3;
+
+    struct OpenEntry {
+        int fCost;
+        int hCost;
+        int node;
+
+        bool operator>(const OpenEntry& other) const {
+            if (fCost == other.fCost) {
+                return hCost > other.hCost;
+            }
+            return fCost > other.fCost;
+        }
+    };
+
+    int cellIndex(const Grid& grid, const Vec2i& pos) {
+        return pos.y * grid.getWidth() + pos.x;
+    }
+
+} // anonymous namespace
+
+CooperativePlanner::CooperativePlanner()
+    : m_allowDiagonal(false)
+    , m_window(16)
+    , m_replanInterval(8)
+    , m_stepsSincePlan(0)
+    , m_hasPlan(false)
+    , m_cachedDistanceNodes(0)
+    , m_goalDistancesContentId(0)
+{
+}
+
+void CooperativePlanner::setWindow(int window) {
+    m_window = std::max(window, 1);
+    m_replanInterval = std::min(m_replanInterval, m_window);
+    m_hasPlan = false;
+}
+
+void CooperativePlanner::setReplanInterval(int steps) {
+    m_replanInterval = std::clamp(steps, 1, m_window);
+}
+
+int CooperativePlanner::addAgent(const Vec2i& start, const Vec2i& goal) {
+    m_agents.push_back({ start, goal, { start } });
+    m_priorityOrder.push_back(static_cast<int>(m_agents.size()) - 1);
+    m_hasPlan = false;
+    return static_cast<int>(m_agents.size()) - 1;
+}
+
+void CooperativePlanner::setGoal(int agentId, const Vec2i& goal) {
+    assert(agentId >= 0 && agentId < static_cast<int>(m_agents.size()) && "Invalid agent id");
+    m_agents[agentId].goal = goal;
+    m_hasPlan = false;
+}
+
+void CooperativePlanner::clearAgents() {
+    m_agents.clear();
+    m_priorityOrder.clear();
+    m_hasPlan = false;
+}
+
+Vec2i CooperativePlanner::getPosition(int agentId) const {
+    assert(agentId >= 0 && agentId < static_cast<int>(m_agents.size()) && "Invalid agent id");
+    return m_agents[agentId].position;
+}
+
+bool CooperativePlanner::hasReachedGoal(int agentId) const {
+    assert(agentId >= 0 && agentId < static_cast<int>(m_agents.size()) && "Invalid agent id");
+    return m_agents[agentId].position == m_agents[agentId].goal;
+}
+
+const std::vector<Vec2i>& CooperativePlanner::getPlan(int agentId) const {
+    assert(agentId >= 0 && agentId < static_cast<int>(m_agents.size()) && "Invalid agent id");
+    return m_agents[agentId].plan;
+}
+
+void CooperativePlanner::invalidateHeuristics() {
+    m_goalDistances.clear();
+    m_cachedDistanceNodes = 0;
+}
+
+void CooperativePlanner::plan(const Grid& grid) {
+    m_lastStats = SearchStats();
+
+    if (grid.getContentId() != m_goalDistancesContentId) {
+        invalidateHeuristics();
+        m_goalDistancesContentId = grid.getContentId();
+    }
+
+    // Rotate priorities between windows, then let agents still travelling
+    // plan before the ones parked on their goal, so the parked ones yield
+    if (m_hasPlan && !m_priorityOrder.empty()) {
+        std::rotate(m_priorityOrder.begin(), m_priorityOrder.begin() + 1, m_priorityOrder.end());
+    }
+    std::stable_partition(m_priorityOrder.begin(), m_priorityOrder.end(),
+        [this](int id) { return m_agents[id].position != m_agents[id].goal; });
+
+    // An agent that found no plan couldn't even wait where it stands, so
+    // someone planned earlier passes through its cell. Promote the stuck
+    // agents, keep everyone out of their cells for the whole window, and
+    // try again. An agent whose cell is held can always wait, so it is
+    // never stuck twice.
+    m_holdsCell.assign(m_agents.size(), false);
+    std::vector<int> stuck;
+
+    for (int attempt = 0; attempt < MAX_PLAN_ATTEMPTS; ++attempt) {
+        stuck = planInPriorityOrder(grid);
+        if (stuck.empty()) {
+            break;
+        }
+
+        for (int id : stuck) {
+            m_holdsCell[id] = true;
+        }
+        std::stable_partition(m_priorityOrder.begin(), m_priorityOrder.end(),
+            [&stuck](int id) { return std::find(stuck.begin(), stuck.end(), id) != stuck.end(); });
+    }
+
+    // Out of attempts with stay-put plans still colliding: hold every cell,
+    // which leaves nobody stuck
+    if (!stuck.empty()) {
+        m_holdsCell.assign(m_agents.size(), true);
+        planInPriorityOrder(grid);
+    }
+
+    m_stepsSincePlan = 0;
+    m_hasPlan = true;
+}
+
+std::vector<int> CooperativePlanner::planInPriorityOrder(const Grid& grid) {
+    m_reservations.reset(grid.getWidth(), grid.getHeight(), m_window + 1);
+    m_unplanned.reset(grid.getWidth(), grid.getHeight(), 2);
+
+    // Everyone occupies their current cell at the start of the window
+    for (size_t id = 0; id < m_agents.size(); ++id) {
+        m_reservations.reserve(m_agents[id].position, 0);
+        m_unplanned.reserve(m_agents[id].position, 0);
+        if (m_holdsCell[id]) {
+            m_unplanned.reserve(m_agents[id].position, 1);
+        }
+    }
+
+    std::vector<int> stuck;
+
+    for (int id : m_priorityOrder) {
+        PlannedAgent& agent = m_agents[id];
+        m_unplanned.release(agent.position, 0);
+        m_unplanned.release(agent.position, 1);
+
+        if (!planAgent(grid, agent)) {
+            stuck.push_back(id);
+        }
+
+        for (int t = 1; t < static_cast<int>(agent.plan.size()); ++t) {
+            m_reservations.reserve(agent.plan[t], t);
+        }
+    }
+
+    return stuck;
+}
+
+void CooperativePlanner::step(const Grid& grid) {
+    if (!m_hasPlan || m_stepsSincePlan >= m_replanInterval) {
+        plan(grid);
+    }
+
+    ++m_stepsSincePlan;
+
+    for (PlannedAgent& agent : m_agents) {
+        size_t index = std::min(static_cast<size_t>(m_stepsSincePlan), agent.plan.size() - 1);
+        agent.position = agent.plan[index];
+    }
+}
+
+bool CooperativePlanner::planAgent(const Grid& grid, PlannedAgent& agent) {
+    const int depth = m_window + 1;
+    ResumableDistance* distances = getGoalDistances(grid, agent.goal, agent.position);
+
+    m_nodes.clear();
+    m_nodeLookup.clear();
+
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openSet;
+
+    auto stateKey = [&](const Vec2i& pos, int time) {
+        return static_cast<int64_t>(cellIndex(grid, pos)) * depth + time;
+    };
+
+    // Adds or relaxes a (cell, time) state
+    auto discover = [&](const Vec2i& pos, int time, int gCost, int parent) {
+        auto [it, inserted] = m_nodeLookup.try_emplace(stateKey(pos, time), static_cast<int>(m_nodes.size()));
+
+        if (inserted) {
+            int hCost = heuristic(grid, distances, pos, agent.goal);
+            m_nodes.push_back({ pos, time, gCost, hCost, parent, false });
+            openSet.push({ gCost + hCost, hCost, it->second });
+            ++m_lastStats.nodesGenerated;
+        }
+        else {
+            SpaceTimeNode& existing = m_nodes[it->second];
+            if (!existing.closed && gCost < existing.gCost) {
+                existing.gCost = gCost;
+                existing.parent = parent;
+                openSet.push({ gCost + existing.hCost, existing.hCost, it->second });
+            }
+        }
+    };
+
+    discover(agent.position, 0, 0, -1);
+
+    int terminal = -1;
+
+    while (!openSet.empty()) {
+        OpenEntry entry = openSet.top();
+        openSet.pop();
+
+        SpaceTimeNode& current = m_nodes[entry.node];
+        if (current.closed || entry.fCost != current.gCost + current.hCost) {
+            continue;
+        }
+        current.closed = true;
+        ++m_lastStats.nodesExpanded;
+
+        // Done once the window is exhausted, or once the goal is reached and
+        // nobody needs the goal cell for the rest of the window
+        if (current.time == m_window
+            || (current.pos == agent.goal && !m_reservations.isReservedFrom(agent.goal, current.time + 1))) {
+            terminal = entry.node;
+            break;
+        }
+
+        // Copies, since discover() may reallocate m_nodes
+        const Vec2i pos = current.pos;
+        const int nextTime = current.time + 1;
+        const int gCost = current.gCost;
+
+        // Waiting is free only on the goal itself
+        if (!m_reservations.isReserved(pos, nextTime)) {
+            discover(pos, nextTime, gCost + (pos == agent.goal ? 0 : Movement::CARDINAL_COST), entry.node);
+        }
+
+        for (const Vec2i& dir : Movement::CARDINAL_DIRS) {
+            Vec2i next = pos + dir;
+            if (grid.isWalkable(next) && canEnter(pos, next, nextTime)) {
+                discover(next, nextTime, gCost + Movement::CARDINAL_COST, entry.node);
+            }
+        }
+
+        if (m_allowDiagonal) {
+            for (const Vec2i& dir : Movement::DIAGONAL_DIRS) {
+                Vec2i next = pos + dir;
+                if (grid.isWalkable(next) && Movement::isDiagonalClear(grid, pos, dir)
+                    && canEnter(pos, next, nextTime)) {
+                    discover(next, nextTime, gCost + Movement::DIAGONAL_COST, entry.node);
+                }
+            }
+        }
+    }
+
+    agent.plan.assign(depth, agent.position);
+
+    // Boxed in for the whole window: stay put
+    if (terminal < 0) {
+        return false;
+    }
+
+    for (int node = terminal; node >= 0; node = m_nodes[node].parent) {
+        agent.plan[m_nodes[node].time] = m_nodes[node].pos;
+    }
+
+    // Hold the final cell for the remainder of the window
+    for (int t = m_nodes[terminal].time + 1; t < depth; ++t) {
+        agent.plan[t] = m_nodes[terminal].pos;
+    }
+
+    return true;
+}
+
+bool CooperativePlanner::canEnter(const Vec2i& from, const Vec2i& to, int time) const {
+    if (m_reservations.isReserved(to, time)) {
+        return false;
+    }
+
+    if (m_unplanned.isReserved(to, time == 1 ? 0 : 1)) {
+        return false;
+    }
+
+    // Reject head-on swaps. The table doesn't record who holds a cell, so
+    // this also refuses moves into a cell being vacated towards us by another
+    // agent, which is conservative but never unsafe.
+    return !(m_reservations.isReserved(to, time - 1) && m_reservations.isReserved(from, time));
+}
+
+int CooperativePlanner::heuristic(const Grid& grid, ResumableDistance* distances,
+    const Vec2i& pos, const Vec2i& goal)
+{
+    if (distances) {
+        const size_t nodesBefore = distances->getNodeCount();
+        int dist = distances->getDistance(grid, pos);
+        m_cachedDistanceNodes += distances->getNodeCount() - nodesBefore;
+
+        if (dist != ResumableDistance::UNREACHABLE) {
+            return dist;
+        }
+    }
+    return Movement::distance(pos, goal, m_allowDiagonal);
+}
+
+ResumableDistance* CooperativePlanner::getGoalDistances(const Grid& grid, const Vec2i& goal, const Vec2i& origin) {
+    if (!grid.isInBounds(goal)) {
+        return nullptr;
+    }
+
+    auto it = m_goalDistances.find(cellIndex(grid, goal));
+    if (it != m_goalDistances.end()) {
+        return &it->second;
+    }
+
+    if (m_cachedDistanceNodes > HEURISTIC_CACHE_BUDGET) {
+        // Too much cached already; fall back to the geometric heuristic
+        return nullptr;
+    }
+
+    // Aimed at the first agent to ask; others heading to the same goal
+    // resume the same search from wherever it stopped
+    ResumableDistance& distances = m_goalDistances[cellIndex(grid, goal)];
+    distances.reset(grid, goal, origin, m_allowDiagonal);
+    return &distances;
+}
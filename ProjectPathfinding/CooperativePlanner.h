@@ -0,0 +1,113 @@
+#pragma once
+#include "Grid.h"
+#include "Pathfinder.h"
+#include "ReservationTable.h"
+#include "ResumableDistance.h"
+#include "Vec2i.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Windowed cooperative A* (WHCA*) for many agents sharing one grid.
+//
+// Agents are planned one after another in priority order. Each one searches
+// in (cell, time) space up to the window depth and reserves the cells it will
+// occupy, so later agents route around it instead of through it. Plans are
+// recomputed every replan interval, and priorities rotate between windows so
+// no agent is permanently last.
+class CooperativePlanner {
+public:
+    CooperativePlanner();
+
+    void setAllowDiagonal(bool allow) { m_allowDiagonal = allow; invalidateHeuristics(); }
+    bool getAllowDiagonal() const { return m_allowDiagonal; }
+
+    // Number of timesteps each agent looks ahead
+    void setWindow(int window);
+    int getWindow() const { return m_window; }
+
+    // Timesteps executed before the next rolling replan, at most the window
+    void setReplanInterval(int steps);
+    int getReplanInterval() const { return m_replanInterval; }
+
+    // Agents are identified by their insertion index
+    int addAgent(const Vec2i& start, const Vec2i& goal);
+    void setGoal(int agentId, const Vec2i& goal);
+    void clearAgents();
+
+    size_t getAgentCount() const { return m_agents.size(); }
+    Vec2i getPosition(int agentId) const;
+    bool hasReachedGoal(int agentId) const;
+
+    // Cells the agent will occupy, one per timestep from the start of the current window
+    const std::vector<Vec2i>& getPlan(int agentId) const;
+
+    // Plans every agent for a fresh window starting at their current positions
+    void plan(const Grid& grid);
+
+    // Moves every agent one timestep, replanning when the window runs out
+    void step(const Grid& grid);
+
+    // Distance maps used as heuristics are cached per goal, and dropped by
+    // plan() once the grid's content id differs from the one they were
+    // built on. This drops them early, to free their memory.
+    void invalidateHeuristics();
+
+    // Totals across all agents for the most recent plan()
+    const SearchStats& getLastPlanStats() const { return m_lastStats; }
+
+private:
+    struct PlannedAgent {
+        Vec2i position;
+        Vec2i goal;
+        std::vector<Vec2i> plan;
+    };
+
+    struct SpaceTimeNode {
+        Vec2i pos;
+        int time;
+        int gCost;
+        int hCost;
+        int parent;
+        bool closed;
+    };
+
+    bool m_allowDiagonal;
+    int m_window;
+    int m_replanInterval;
+
+    std::vector<PlannedAgent> m_agents;
+    std::vector<int> m_priorityOrder;
+
+    ReservationTable m_reservations;
+
+    // Current cells of agents not yet planned this window (time 0), and
+    // the subset held for the whole window (time 1). Nobody may step into
+    // the first on the first move, or into the second at all, so an agent
+    // whose cell is held can always fall back to waiting where it is.
+    ReservationTable m_unplanned;
+    std::vector<bool> m_holdsCell;
+    int m_stepsSincePlan;
+    bool m_hasPlan;
+
+    // True-distance heuristics keyed by goal cell index, each filled in only
+    // as far as the agents heading there have asked
+    std::unordered_map<int, ResumableDistance> m_goalDistances;
+    size_t m_cachedDistanceNodes;
+    unsigned long long m_goalDistancesContentId;
+
+    // Search scratch space, reused between agents to avoid reallocating
+    std::vector<SpaceTimeNode> m_nodes;
+    std::unordered_map<int64_t, int> m_nodeLookup;
+
+    SearchStats m_lastStats;
+
+    // Returns the agents whose search failed
+    std::vector<int> planInPriorityOrder(const Grid& grid);
+
+    // Returns false if the agent can't even wait in place for the window
+    bool planAgent(const Grid& grid, PlannedAgent& agent);
+    int heuristic(const Grid& grid, ResumableDistance* distances, const Vec2i& pos, const Vec2i& goal);
+    ResumableDistance* getGoalDistances(const Grid& grid, const Vec2i& goal, const Vec2i& origin);
+    bool canEnter(const Vec2i& from, const Vec2i& to, int time) const;
+};
@@ -0,0 +1,186 @@
+#include "DistanceMap.h"
+#include "Movement.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <utility>
+
+namespace {
+
+    // Below this many cells the bucket synchronization costs more than it saves
+    constexpr size_t PARALLEL_MIN_CELLS = 64 * 64;
+
+} // anonymous namespace
+
+DistanceMap::DistanceMap()
+    : m_allowDiagonal(false)
+    , m_width(0)
+    , m_height(0)
+    , m_source(0, 0)
+{
+}
+
+void DistanceMap::compute(const Grid& grid, const Vec2i& source, ThreadPool* pool) {
+    m_width = grid.getWidth();
+    m_height = grid.getHeight();
+    m_source = source;
+
+    const size_t cellCount = static_cast<size_t>(m_width) * static_cast<size_t>(m_height);
+
+    if (!grid.isInBounds(source)) {
+        m_distances.assign(cellCount, UNREACHABLE);
+        return;
+    }
+
+    if (pool && pool->getWorkerCount() > 1 && cellCount >= PARALLEL_MIN_CELLS) {
+        computeParallel(grid, *pool);
+    }
+    else {
+        computeSequential(grid);
+    }
+}
+
+int DistanceMap::getDistance(const Vec2i& pos) const {
+    if (pos.x < 0 || pos.x >= m_width || pos.y < 0 || pos.y >= m_height) {
+        return UNREACHABLE;
+    }
+    return m_distances[static_cast<size_t>(pos.y) * m_width + pos.x];
+}
+
+void DistanceMap::computeSequential(const Grid& grid) {
+    m_distances.assign(static_cast<size_t>(m_width) * m_height, UNREACHABLE);
+
+    using QueueEntry = std::pair<int, int>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+    const int sourceIndex = m_source.y * m_width + m_source.x;
+    m_distances[sourceIndex] = 0;
+    queue.push({ 0, sourceIndex });
+
+    while (!queue.empty()) {
+        const int dist = queue.top().first;
+        const int index = queue.top().second;
+        queue.pop();
+
+        // Stale entry, the cell was settled through a cheaper route
+        if (dist > m_distances[index]) {
+            continue;
+        }
+
+        Vec2i pos = { index % m_width, index / m_width };
+
+        Movement::forEachNeighbor(grid, pos, m_allowDiagonal, [&](const Vec2i& next, int cost) {
+            int nextIndex = next.y * m_width + next.x;
+            if (dist + cost < m_distances[nextIndex]) {
+                m_distances[nextIndex] = dist + cost;
+                queue.push({ dist + cost, nextIndex });
+            }
+        });
+    }
+}
+
+void DistanceMap::computeParallel(const Grid& grid, ThreadPool& pool) {
+    const size_t cellCount = static_cast<size_t>(m_width) * static_cast<size_t>(m_height);
+    const unsigned workerCount = pool.getWorkerCount();
+
+    std::unique_ptr<std::atomic<int>[]> distances(new std::atomic<int>[cellCount]);
+    pool.parallelFor(cellCount, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            distances[i].store(UNREACHABLE, std::memory_order_relaxed);
+        }
+    });
+
+    // buckets[worker][bucket] holds cells that worker improved into that bucket.
+    // Workers only ever append to their own lists, so no locking is needed.
+    std::vector<std::vector<std::vector<int>>> buckets(workerCount);
+
+    auto pushToBucket = [&](unsigned worker, int dist, int cell) {
+        size_t bucket = static_cast<size_t>(dist / DELTA);
+        std::vector<std::vector<int>>& own = buckets[worker];
+        if (own.size() <= bucket) {
+            own.resize(bucket + 1);
+        }
+        own[bucket].push_back(cell);
+    };
+
+    const int sourceIndex = m_source.y * m_width + m_source.x;
+    distances[sourceIndex].store(0, std::memory_order_relaxed);
+    pushToBucket(0, 0, sourceIndex);
+
+    std::vector<int> frontier;
+    size_t current = 0;
+
+    while (true) {
+        // Advance to the lowest non-empty bucket across all workers
+        size_t next = SIZE_MAX;
+        for (const auto& own : buckets) {
+            for (size_t b = current; b < own.size() && b < next; ++b) {
+                if (!own[b].empty()) {
+                    next = b;
+                    break;
+                }
+            }
+        }
+
+        if (next == SIZE_MAX) {
+            break;
+        }
+        current = next;
+
+        // Relaxing cells in this bucket can put more cells into it (all edges
+        // are shorter than DELTA), so keep draining until it stays empty
+        while (true) {
+            frontier.clear();
+            for (auto& own : buckets) {
+                if (current < own.size()) {
+                    frontier.insert(frontier.end(), own[current].begin(), own[current].end());
+                    std::vector<int>().swap(own[current]);
+                }
+            }
+
+            if (frontier.empty()) {
+                break;
+            }
+
+            pool.parallelFor(frontier.size(), [&](size_t begin, size_t end, unsigned worker) {
+                for (size_t i = begin; i < end; ++i) {
+                    const int cell = frontier[i];
+                    const int dist = distances[cell].load(std::memory_order_relaxed);
+
+                    // Stale entry, the cell has since moved to a lower bucket
+                    if (static_cast<size_t>(dist / DELTA) != current) {
+                        continue;
+                    }
+
+                    Vec2i pos = { cell % m_width, cell / m_width };
+
+                    Movement::forEachNeighbor(grid, pos, m_allowDiagonal, [&](const Vec2i& neighbor, int cost) {
+                        const int neighborIndex = neighbor.y * m_width + neighbor.x;
+                        const int newDist = dist + cost;
+
+                        int oldDist = distances[neighborIndex].load(std::memory_order_relaxed);
+                        while (newDist < oldDist) {
+                            if (distances[neighborIndex].compare_exchange_weak(oldDist, newDist,
+                                std::memory_order_relaxed)) {
+                                pushToBucket(worker, newDist, neighborIndex);
+                                break;
+                            }
+                        }
+                    });
+                }
+            });
+        }
+
+        ++current;
+    }
+
+    m_distances.resize(cellCount);
+    pool.parallelFor(cellCount, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            m_distances[i] = distances[i].load(std::memory_order_relaxed);
+        }
+    });
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Grid.h"
+#include "Vec2i.h"
+#include <climits>
+#include <vector>
+
+class ThreadPool;
+
+// Dense single-source shortest-path distances over a Grid, using the same
+// 10/14 costs and corner-cutting rule as Pathfinder::findPath.
+//
+// With a thread pool, large grids are solved with parallel delta-stepping:
+// cells are grouped into distance buckets of width DELTA, and every cell in
+// the current bucket is relaxed concurrently, with each worker collecting the
+// cells it improves into its own buckets. Without one, or on small grids, a
+// sequential Dijkstra is used. Both produce identical distances.
+class DistanceMap {
+public:
+    static constexpr int UNREACHABLE = INT_MAX;
+
+    // Bucket width for delta-stepping, in cost units
+    static constexpr int DELTA = 40;
+
+    DistanceMap();
+
+    void setAllowDiagonal(bool allow) { m_allowDiagonal = allow; }
+    bool getAllowDiagonal() const { return m_allowDiagonal; }
+
+    // Recomputes every distance from source. Pass a pool to run in parallel.
+    void compute(const Grid& grid, const Vec2i& source, ThreadPool* pool = nullptr);
+
+    int getDistance(const Vec2i& pos) const;
+
+    // Row-major, index y * width + x
+    const std::vector<int>& getDistances() const { return m_distances; }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    const Vec2i& getSource() const { return m_source; }
+
+private:
+    bool m_allowDiagonal;
+    int m_width;
+    int m_height;
+    Vec2i m_source;
+    std::vector<int> m_distances;
+
+    void computeSequential(const Grid& grid);
+    void computeParallel(const Grid& grid, ThreadPool& pool);
+};
@@ -0,0 +1,315 @@
+#include "FirstMoveTable.h"
+#include "Movement.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+    // Moves are stored in 3 bits, leaving the rest of a run for the target rank
+    constexpr int MOVE_BITS = 3;
+    constexpr uint32_t MOVE_MASK = (1u << MOVE_BITS) - 1;
+    constexpr size_t MAX_RANKED_CELLS = size_t(1) << (32 - MOVE_BITS);
+
+    // Cardinal moves first, then diagonal, matching the documented indices
+    constexpr Vec2i MOVES[] = {
+        Movement::CARDINAL_DIRS[0], Movement::CARDINAL_DIRS[1],
+        Movement::CARDINAL_DIRS[2], Movement::CARDINAL_DIRS[3],
+        Movement::DIAGONAL_DIRS[0], Movement::DIAGONAL_DIRS[1],
+        Movement::DIAGONAL_DIRS[2], Movement::DIAGONAL_DIRS[3]
+    };
+
+    // Spreads the low 32 bits of v out to the even bit positions
+    uint64_t spreadBits(uint64_t v) {
+        v &= 0xFFFFFFFFull;
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v << 8))  & 0x00FF00FF00FF00FFull;
+        v = (v | (v << 4))  & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v << 2))  & 0x3333333333333333ull;
+        v = (v | (v << 1))  & 0x5555555555555555ull;
+        return v;
+    }
+
+    uint64_t mortonCode(const Vec2i& pos) {
+        return spreadBits(static_cast<uint32_t>(pos.x)) | (spreadBits(static_cast<uint32_t>(pos.y)) << 1);
+    }
+
+    // Dijkstra buffers reused by one worker across all of its sources
+    struct SearchScratch {
+        std::vector<int> distances;
+        std::vector<int8_t> firstMoves;
+        std::vector<std::pair<int, int>> heap;
+    };
+
+} // anonymous namespace
+
+FirstMoveTable::FirstMoveTable()
+    : m_allowDiagonal(false)
+    , m_built(false)
+    , m_width(0)
+    , m_height(0)
+    , m_gridContentId(0)
+    , m_buildSeconds(0.0)
+{
+}
+
+bool FirstMoveTable::build(const Grid& grid, ThreadPool& pool) {
+    auto buildStart = std::chrono::steady_clock::now();
+
+    m_built = false;
+    m_width = grid.getWidth();
+    m_height = grid.getHeight();
+    m_gridContentId = grid.getContentId();
+    m_runs.clear();
+    m_rowOffsets.clear();
+
+    std::vector<Vec2i> cellsByRank;
+    indexCells(grid, cellsByRank);
+
+    if (cellsByRank.size() > MAX_RANKED_CELLS) {
+        std::cerr << "Error: Too many walkable cells for a first-move table.\n";
+        return false;
+    }
+
+    labelComponents(grid);
+
+    const size_t sourceCount = cellsByRank.size();
+    const size_t cellCount = static_cast<size_t>(m_width) * m_height;
+    const int moveCount = m_allowDiagonal ? 8 : 4;
+
+    std::vector<std::vector<uint32_t>> rows(sourceCount);
+    std::vector<SearchScratch> scratch(pool.getWorkerCount());
+
+    pool.parallelFor(sourceCount, [&](size_t begin, size_t end, unsigned worker) {
+        SearchScratch& own = scratch[worker];
+        own.distances.resize(cellCount);
+        own.firstMoves.resize(cellCount);
+
+        for (size_t sourceRank = begin; sourceRank < end; ++sourceRank) {
+            const Vec2i source = cellsByRank[sourceRank];
+            const int sourceIndex = cellIndex(source);
+
+            std::fill(own.distances.begin(), own.distances.end(), INT_MAX);
+            own.distances[sourceIndex] = 0;
+            own.firstMoves[sourceIndex] = -1;
+
+            // Every cell inherits the first move of the cell it was reached from
+            auto& heap = own.heap;
+            heap.clear();
+            heap.push_back({ 0, sourceIndex });
+
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+                const int dist = heap.back().first;
+                const int index = heap.back().second;
+                heap.pop_back();
+
+                if (dist > own.distances[index]) {
+                    continue;
+                }
+
+                const Vec2i pos = { index % m_width, index / m_width };
+
+                for (int move = 0; move < moveCount; ++move) {
+                    const Vec2i& dir = MOVES[move];
+                    const Vec2i next = pos + dir;
+                    const bool diagonal = move >= 4;
+
+                    if (!grid.isWalkable(next) || (diagonal && !Movement::isDiagonalClear(grid, pos, dir))) {
+                        continue;
+                    }
+
+                    const int nextIndex = cellIndex(next);
+                    const int nextDist = dist + (diagonal ? Movement::DIAGONAL_COST : Movement::CARDINAL_COST);
+
+                    if (nextDist < own.distances[nextIndex]) {
+                        own.distances[nextIndex] = nextDist;
+                        own.firstMoves[nextIndex] = index == sourceIndex
+                            ? static_cast<int8_t>(move)
+                            : own.firstMoves[index];
+                        heap.push_back({ nextDist, nextIndex });
+                        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                    }
+                }
+            }
+
+            // Run-length encode the row in Morton order. The first run always
+            // starts at rank 0 so every lookup lands inside some run.
+            const int sourceComponent = m_component[sourceIndex];
+            std::vector<uint32_t>& row = rows[sourceRank];
+            int currentMove = -1;
+
+            for (size_t targetRank = 0; targetRank < sourceCount; ++targetRank) {
+                const int targetIndex = cellIndex(cellsByRank[targetRank]);
+                if (targetRank == sourceRank || m_component[targetIndex] != sourceComponent) {
+                    continue;
+                }
+
+                const int move = own.firstMoves[targetIndex];
+                if (move == currentMove) {
+                    continue;
+                }
+
+                const uint32_t start = currentMove < 0 ? 0 : static_cast<uint32_t>(targetRank);
+                row.push_back((start << MOVE_BITS) | static_cast<uint32_t>(move));
+                currentMove = move;
+            }
+
+            row.shrink_to_fit();
+        }
+    });
+
+    size_t totalRuns = 0;
+    for (const auto& row : rows) {
+        totalRuns += row.size();
+    }
+
+    m_runs.reserve(totalRuns);
+    m_rowOffsets.reserve(sourceCount + 1);
+    m_rowOffsets.push_back(0);
+
+    for (auto& row : rows) {
+        m_runs.insert(m_runs.end(), row.begin(), row.end());
+        m_rowOffsets.push_back(m_runs.size());
+        std::vector<uint32_t>().swap(row);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - buildStart;
+    m_buildSeconds = elapsed.count();
+    m_built = true;
+    return true;
+}
+
+void FirstMoveTable::indexCells(const Grid& grid, std::vector<Vec2i>& cellsByRank) {
+    cellsByRank.clear();
+
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            if (grid.isWalkable({ x, y })) {
+                cellsByRank.push_back({ x, y });
+            }
+        }
+    }
+
+    std::sort(cellsByRank.begin(), cellsByRank.end(), [](const Vec2i& a, const Vec2i& b) {
+        return mortonCode(a) < mortonCode(b);
+    });
+
+    m_rank.assign(static_cast<size_t>(m_width) * m_height, -1);
+    for (size_t rank = 0; rank < cellsByRank.size(); ++rank) {
+        m_rank[cellIndex(cellsByRank[rank])] = static_cast<int32_t>(rank);
+    }
+}
+
+void FirstMoveTable::labelComponents(const Grid& grid) {
+    // Corner cutting is never allowed, so a diagonal move always has a
+    // cardinal detour and 4-connected components are exact for both modes
+    m_component.assign(static_cast<size_t>(m_width) * m_height, -1);
+
+    std::vector<Vec2i> stack;
+    int32_t nextComponent = 0;
+
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            if (!grid.isWalkable({ x, y }) || m_component[cellIndex({ x, y })] >= 0) {
+                continue;
+            }
+
+            m_component[cellIndex({ x, y })] = nextComponent;
+            stack.push_back({ x, y });
+
+            while (!stack.empty()) {
+                Vec2i pos = stack.back();
+                stack.pop_back();
+
+                Movement::forEachNeighbor(grid, pos, false, [&](const Vec2i& next, int) {
+                    int32_t& component = m_component[cellIndex(next)];
+                    if (component < 0) {
+                        component = nextComponent;
+                        stack.push_back(next);
+                    }
+                });
+            }
+
+            ++nextComponent;
+        }
+    }
+}
+
+bool FirstMoveTable::matches(const Grid& grid) const {
+    return m_built
+        && grid.getWidth() == m_width
+        && grid.getHeight() == m_height
+        && grid.getContentId() == m_gridContentId;
+}
+
+bool FirstMoveTable::isRankedCell(const Vec2i& pos) const {
+    return m_built
+        && pos.x >= 0 && pos.x < m_width && pos.y >= 0 && pos.y < m_height
+        && m_rank[cellIndex(pos)] >= 0;
+}
+
+int FirstMoveTable::getFirstMove(const Vec2i& source, const Vec2i& target) const {
+    if (source == target || !isRankedCell(source) || !isRankedCell(target)) {
+        return NO_MOVE;
+    }
+
+    const int sourceIndex = cellIndex(source);
+    const int targetIndex = cellIndex(target);
+
+    if (m_component[sourceIndex] != m_component[targetIndex]) {
+        return NO_MOVE;
+    }
+
+    auto rowBegin = m_runs.begin() + static_cast<std::ptrdiff_t>(m_rowOffsets[m_rank[sourceIndex]]);
+    auto rowEnd = m_runs.begin() + static_cast<std::ptrdiff_t>(m_rowOffsets[m_rank[sourceIndex] + 1]);
+
+    // Last run starting at or before the target's rank
+    const uint32_t key = (static_cast<uint32_t>(m_rank[targetIndex]) << MOVE_BITS) | MOVE_MASK;
+    auto run = std::upper_bound(rowBegin, rowEnd, key);
+    if (run == rowBegin) {
+        return NO_MOVE;
+    }
+
+    return static_cast<int>(*(run - 1) & MOVE_MASK);
+}
+
+std::vector<Vec2i> FirstMoveTable::extractPath(const Vec2i& source, const Vec2i& target) const {
+    if (!isRankedCell(source) || !isRankedCell(target)) {
+        return {};
+    }
+
+    if (source == target) {
+        return { source };
+    }
+
+    std::vector<Vec2i> path = { source };
+    Vec2i current = source;
+
+    // Every step strictly shortens the remaining optimal cost, so this bound
+    // is only hit if the table doesn't belong to the grid being walked
+    const size_t maxSteps = getSourceCount();
+
+    while (current != target) {
+        int move = getFirstMove(current, target);
+        if (move == NO_MOVE || path.size() > maxSteps) {
+            return {};
+        }
+
+        current = current + MOVES[move];
+        path.push_back(current);
+    }
+
+    return path;
+}
+
+size_t FirstMoveTable::getMemoryBytes() const {
+    return m_runs.size() * sizeof(uint32_t)
+        + m_rowOffsets.size() * sizeof(size_t)
+        + m_rank.size() * sizeof(int32_t)
+        + m_component.size() * sizeof(int32_t);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Grid.h"
+#include "Vec2i.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Compressed path database: the optimal first move for every pair of
+// walkable cells, so a path can be read off one step at a time without
+// searching. Only valid for the grid contents it was built from.
+//
+// Built offline with one Dijkstra per source cell, spread over a thread
+// pool. Each source's row lists the first move towards every target, with
+// targets ordered along a Morton (Z-order) curve so that nearby targets,
+// which usually share a first move, sit next to each other. Rows are then
+// run-length encoded. Targets in another connected component, and the
+// source itself, never need an answer, so they extend whichever run they
+// fall in instead of breaking it.
+class FirstMoveTable {
+public:
+    // Returned when the target can't be reached (or is the source)
+    static constexpr int NO_MOVE = -1;
+
+    FirstMoveTable();
+
+    void setAllowDiagonal(bool allow) { m_allowDiagonal = allow; }
+    bool getAllowDiagonal() const { return m_allowDiagonal; }
+
+    // Replaces the table with one for the grid's current contents.
+    // Returns false if the grid has too many walkable cells to index.
+    bool build(const Grid& grid, ThreadPool& pool);
+
+    bool isBuilt() const { return m_built; }
+
+    // True if the table was built from this grid's current cells
+    bool matches(const Grid& grid) const;
+
+    // Index into Movement::CARDINAL_DIRS (0-3) or Movement::DIAGONAL_DIRS (4-7)
+    int getFirstMove(const Vec2i& source, const Vec2i& target) const;
+
+    // Full path from source to target by repeated lookups, or empty if
+    // unreachable or either end isn't a walkable cell of the table's grid
+    std::vector<Vec2i> extractPath(const Vec2i& source, const Vec2i& target) const;
+
+    // Build report
+    double getBuildSeconds() const { return m_buildSeconds; }
+    size_t getSourceCount() const { return m_rowOffsets.empty() ? 0 : m_rowOffsets.size() - 1; }
+    size_t getRunCount() const { return m_runs.size(); }
+    size_t getMemoryBytes() const;
+
+private:
+    bool m_allowDiagonal;
+    bool m_built;
+    int m_width;
+    int m_height;
+    unsigned long long m_gridContentId;
+    double m_buildSeconds;
+
+    // Per cell (row-major): Morton rank among walkable cells, or -1
+    std::vector<int32_t> m_rank;
+
+    // Per cell: connected component id, or -1 for obstacles
+    std::vector<int32_t> m_component;
+
+    // Runs of every row back to back, each packed as (first target rank << 3) | move.
+    // Row r spans [m_rowOffsets[r], m_rowOffsets[r + 1]).
+    std::vector<uint32_t> m_runs;
+    std::vector<size_t> m_rowOffsets;
+
+    void indexCells(const Grid& grid, std::vector<Vec2i>& cellsByRank);
+    void labelComponents(const Grid& grid);
+
+    int cellIndex(const Vec2i& pos) const { return pos.y * m_width + pos.x; }
+
+    // In bounds and walkable when the table was built
+    bool isRankedCell(const Vec2i& pos) const;
+};
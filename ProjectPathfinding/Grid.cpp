@@ -1,18 +1,71 @@
 #include "Grid.h"
+#include <atomic>
 #include <cassert>
 
+namespace {
+
+    std::atomic<unsigned long long> g_nextContentId(1);
+
+    unsigned long long newContentId() {
+        return g_nextContentId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+} // anonymous namespace
+
 Grid::Grid(int width, int height)
     : m_width(width)
     , m_height(height)
     , m_cells(height, std::vector<CellType>(width, CellType::Walkable))
     , m_startPos(std::nullopt)
     , m_endPos(std::nullopt)
+    , m_editDepth(0)
+    , m_version(0)
+    , m_contentId(newContentId())
+    , m_isDirty(static_cast<size_t>(width) * height, false)
+    , m_nextListenerId(0)
+{
+}
+
+Grid::Grid(const Grid& other)
+    : m_width(other.m_width)
+    , m_height(other.m_height)
+    , m_cells(other.m_cells)
+    , m_startPos(other.m_startPos)
+    , m_endPos(other.m_endPos)
+    , m_editDepth(0)
+    , m_version(other.m_version)
+    , m_contentId(other.m_contentId)
+    , m_isDirty(other.m_isDirty.size(), false)
+    , m_nextListenerId(0)
 {
+    assert(!other.isEditing() && "Copying a grid in the middle of an edit");
+}
+
+Grid& Grid::operator=(const Grid& other) {
+    assert(!isEditing() && !other.isEditing() && "Assigning a grid in the middle of an edit");
+
+    if (this == &other) {
+        return *this;
+    }
+
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_cells = other.m_cells;
+    m_startPos = other.m_startPos;
+    m_endPos = other.m_endPos;
+    m_version = other.m_version;
+    m_contentId = other.m_contentId;
+    m_dirtyCells.clear();
+    m_originalTypes.clear();
+    m_isDirty.assign(other.m_isDirty.size(), false);
+    return *this;
 }
 
 void Grid::setCellType(const Vec2i& pos, CellType type) {
     assert(isInBounds(pos) && "Grid coordinates out of bounds");
 
+    beginEdit();
+
     if (type == CellType::Start) {
         updateSpecialCell(type, m_startPos, pos);
     }
@@ -20,7 +73,78 @@ void Grid::setCellType(const Vec2i& pos, CellType type) {
         updateSpecialCell(type, m_endPos, pos);
     }
 
-    m_cells[pos.y][pos.x] = type;
+    writeCell(pos, type);
+
+    commitEdit();
+}
+
+void Grid::writeCell(const Vec2i& pos, CellType type) {
+    CellType& cell = m_cells[pos.y][pos.x];
+    if (cell == type) {
+        return;
+    }
+
+    size_t index = static_cast<size_t>(pos.y) * m_width + pos.x;
+    if (!m_isDirty[index]) {
+        m_isDirty[index] = true;
+        m_dirtyCells.push_back(pos);
+        m_originalTypes.push_back(cell);
+    }
+
+    cell = type;
+}
+
+void Grid::beginEdit() {
+    ++m_editDepth;
+}
+
+void Grid::commitEdit() {
+    assert(m_editDepth > 0 && "commitEdit without beginEdit");
+
+    if (--m_editDepth > 0 || m_dirtyCells.empty()) {
+        return;
+    }
+
+    // Cells set back to their type from before the transaction are
+    // journaled, but haven't changed
+    GridChangeSet changes;
+    for (size_t i = 0; i < m_dirtyCells.size(); ++i) {
+        const Vec2i& pos = m_dirtyCells[i];
+        m_isDirty[static_cast<size_t>(pos.y) * m_width + pos.x] = false;
+
+        if (m_cells[pos.y][pos.x] != m_originalTypes[i]) {
+            changes.cells.push_back(pos);
+        }
+    }
+    m_dirtyCells.clear();
+    m_originalTypes.clear();
+
+    if (changes.cells.empty()) {
+        return;
+    }
+
+    changes.version = ++m_version;
+    m_contentId = newContentId();
+
+    // Listeners may start a new transaction of their own from here
+    for (const auto& listener : m_listeners) {
+        listener.second(*this, changes);
+    }
+}
+
+int Grid::addListener(GridListener listener) {
+    int id = m_nextListenerId++;
+    m_listeners.emplace_back(id, std::move(listener));
+    return id;
+}
+
+void Grid::removeListener(int id) {
+    for (auto it = m_listeners.begin(); it != m_listeners.end(); ++it) {
+        if (it->first == id) {
+            m_listeners.erase(it);
+            return;
+        }
+    }
 }
 
 void Grid::updateSpecialCell(CellType type, std::optional<Vec2i>& cache, const Vec2i& newPos) {
@@ -31,7 +155,7 @@ void Grid::updateSpecialCell(CellType type, std::optional<Vec2i>& cache, const V
     if (cache) {
         Vec2i old = *cache;
         if (isInBounds(old) && m_cells[old.y][old.x] == type) {
-            m_cells[old.y][old.x] = CellType::Walkable;
+            writeCell(old, CellType::Walkable);
         }
     }
     cache = newPos;
@@ -66,13 +190,17 @@ void Grid::setEnd(const Vec2i& pos) {
 }
 
 void Grid::clear() {
+    beginEdit();
+
     for (int y = 0; y < m_height; ++y) {
         for (int x = 0; x < m_width; ++x) {
-            m_cells[y][x] = CellType::Walkable;
+            writeCell({ x, y }, CellType::Walkable);
         }
     }
     m_startPos = std::nullopt;
     m_endPos = std::nullopt;
+
+    commitEdit();
 }
 
 CellType Grid::getCellType(const Vec2i& pos) const {
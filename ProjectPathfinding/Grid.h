@@ -1,5 +1,6 @@
 #pragma once
 #include "Vec2i.h"
+#include <functional>
 #include <vector>
 #include <optional>
 
@@ -10,10 +11,27 @@ enum class CellType {
     End
 };
 
+class Grid;
+
+// Cells whose type changed in one committed edit, each listed once
+struct GridChangeSet {
+    unsigned long long version;
+    std::vector<Vec2i> cells;
+};
+
+using GridListener = std::function<void(const Grid&, const GridChangeSet&)>;
+
 class Grid {
 public:
     Grid(int width, int height);
 
+    // Copies take the cells, version and content id, but never the
+    // listeners: those belong to the grid they were added to, and usually
+    // capture its owner. Assigning keeps this grid's listeners without
+    // notifying them. Neither grid may be in the middle of an edit.
+    Grid(const Grid& other);
+    Grid& operator=(const Grid& other);
+
     // Cell queries
     CellType getCellType(const Vec2i& pos) const;
     void setCellType(const Vec2i& pos, CellType type);
@@ -33,6 +51,29 @@ public:
     // Clear the grid
     void clear();
 
+    // Edit transactions. Changes made between beginEdit() and commitEdit()
+    // are journaled, and the commit bumps the version and notifies every
+    // listener once with the full change set. Transactions nest; only the
+    // outermost commit publishes, and only cells whose type differs from
+    // before the transaction count as changed. Edits made outside a
+    // transaction are committed on their own.
+    void beginEdit();
+    void commitEdit();
+    bool isEditing() const { return m_editDepth > 0; }
+
+    // Incremented once per commit that changed at least one cell
+    unsigned long long getVersion() const { return m_version; }
+
+    // Identifies the current cells across every grid in the process: it is
+    // renewed on each commit that changed a cell, so two grids (or a grid
+    // and its copy) only share one while their cells are the same. Unlike
+    // the version, it tells data built from one grid apart from another's.
+    unsigned long long getContentId() const { return m_contentId; }
+
+    // Returns an id for removeListener()
+    int addListener(GridListener listener);
+    void removeListener(int id);
+
 private:
     int m_width;
     int m_height;
@@ -42,6 +83,20 @@ private:
     std::optional<Vec2i> m_startPos;
     std::optional<Vec2i> m_endPos;
 
+    // Edit journal
+    int m_editDepth;
+    unsigned long long m_version;
+    unsigned long long m_contentId;
+    std::vector<Vec2i> m_dirtyCells;
+    std::vector<CellType> m_originalTypes;  // Per dirty cell, before the transaction
+    std::vector<bool> m_isDirty;
+
+    std::vector<std::pair<int, GridListener>> m_listeners;
+    int m_nextListenerId;
+
     // Helper to update special case grids - Start and End
     void updateSpecialCell(CellType type, std::optional<Vec2i>& cache, const Vec2i& newPos);
+
+    // Writes a cell, journaling it and its old type on its first change
+    void writeCell(const Vec2i& pos, CellType type);
 };
\ No newline at end of file
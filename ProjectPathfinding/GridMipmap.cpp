@@ -0,0 +1,73 @@
+#include "GridMipmap.h"
+#include <algorithm>
+
+GridMipmap::GridMipmap()
+    : m_width(0)
+    , m_height(0)
+{
+}
+
+void GridMipmap::build(const std::vector<CellType>& cells, int width, int height) {
+    m_width = width;
+    m_height = height;
+    m_levels.clear();
+
+    Level base = { width, height, std::vector<uint32_t>(cells.size()) };
+    for (size_t i = 0; i < cells.size(); ++i) {
+        base.obstacles[i] = cells[i] == CellType::Obstacle ? 1 : 0;
+    }
+    m_levels.push_back(std::move(base));
+
+    // Each block sums the (up to) four blocks below it
+    while (m_levels.back().width > 1 || m_levels.back().height > 1) {
+        const Level& below = m_levels.back();
+        Level level = { (below.width + 1) / 2, (below.height + 1) / 2, {} };
+        level.obstacles.assign(static_cast<size_t>(level.width) * level.height, 0);
+
+        for (int y = 0; y < below.height; ++y) {
+            for (int x = 0; x < below.width; ++x) {
+                level.obstacles[static_cast<size_t>(y / 2) * level.width + x / 2]
+                    += below.obstacles[static_cast<size_t>(y) * below.width + x];
+            }
+        }
+        m_levels.push_back(std::move(level));
+    }
+}
+
+void GridMipmap::setObstacle(const Vec2i& cell, bool obstacle) {
+    if (m_levels.empty() || cell.x < 0 || cell.x >= m_width || cell.y < 0 || cell.y >= m_height) {
+        return;
+    }
+
+    const uint32_t value = obstacle ? 1 : 0;
+    if (m_levels[0].obstacles[static_cast<size_t>(cell.y) * m_width + cell.x] == value) {
+        return;
+    }
+
+    for (size_t level = 0; level < m_levels.size(); ++level) {
+        Level& current = m_levels[level];
+        uint32_t& count = current.obstacles[static_cast<size_t>(cell.y >> level) * current.width + (cell.x >> level)];
+
+        if (obstacle) {
+            ++count;
+        }
+        else {
+            --count;
+        }
+    }
+}
+
+Vec2i GridMipmap::getLevelSize(int level) const {
+    return { m_levels[level].width, m_levels[level].height };
+}
+
+float GridMipmap::getObstacleShare(int level, const Vec2i& block) const {
+    const Level& current = m_levels[level];
+    const int blockCells = 1 << level;
+
+    const int cellsX = std::min(blockCells, m_width - block.x * blockCells);
+    const int cellsY = std::min(blockCells, m_height - block.y * blockCells);
+
+    uint32_t count = current.obstacles[static_cast<size_t>(block.y) * current.width + block.x];
+    return static_cast<float>(count) / static_cast<float>(cellsX * cellsY);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Grid.h"
+#include "Vec2i.h"
+#include <cstdint>
+#include <vector>
+
+// Obstacle counts over square blocks of the grid, one level per power of
+// two, for drawing a zoomed-out grid with one quad per block instead of
+// one per cell. Level 0 holds single cells; each level above halves both
+// dimensions, until one block covers the whole grid. Edits update every
+// level in O(levels).
+class GridMipmap {
+public:
+    GridMipmap();
+
+    // Rebuilds all levels from row-major cells
+    void build(const std::vector<CellType>& cells, int width, int height);
+
+    // Updates the counts for one cell becoming, or no longer being, an obstacle
+    void setObstacle(const Vec2i& cell, bool obstacle);
+
+    int getLevelCount() const { return static_cast<int>(m_levels.size()); }
+
+    // Size of a level in blocks
+    Vec2i getLevelSize(int level) const;
+
+    // Share of the block's cells that are obstacles, from 0 to 1. Blocks on
+    // the right and bottom edges may cover fewer cells than the others.
+    float getObstacleShare(int level, const Vec2i& block) const;
+
+private:
+    struct Level {
+        int width;
+        int height;
+        std::vector<uint32_t> obstacles;
+    };
+
+    int m_width;
+    int m_height;
+    std::vector<Level> m_levels;
+};
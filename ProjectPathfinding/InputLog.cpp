@@ -0,0 +1,155 @@
+#include "InputLog.h"
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+    constexpr const char* LOG_MAGIC = "pathfinding-input";
+    constexpr int LOG_VERSION = 2;
+
+} // anonymous namespace
+
+InputRecorder::InputRecorder()
+    : m_frameIndex(0)
+    , m_elapsedTime(0.0)
+{
+}
+
+bool InputRecorder::open(const std::string& path, int gridWidth, int gridHeight) {
+    m_file.open(path, std::ios::out | std::ios::trunc);
+    if (!m_file) {
+        std::cerr << "Warning: Could not open input log '" << path << "' for writing.\n";
+        return false;
+    }
+
+    // Enough digits for every float to survive the text round trip unchanged
+    m_file << std::setprecision(std::numeric_limits<float>::max_digits10);
+    m_file << LOG_MAGIC << ' ' << LOG_VERSION << ' ' << gridWidth << ' ' << gridHeight << '\n';
+
+    m_frameIndex = 0;
+    m_elapsedTime = 0.0;
+    return true;
+}
+
+void InputRecorder::recordEvent(const InputEvent& event) {
+    if (!m_file.is_open()) {
+        return;
+    }
+
+    switch (event.type) {
+    case InputEvent::Type::MouseClick:
+        m_file << "M " << event.gridPos.x << ' ' << event.gridPos.y << ' '
+            << (event.isLeftClick ? 'L' : 'R') << '\n';
+        break;
+
+    case InputEvent::Type::MouseDrag:
+        m_file << "D " << event.gridPos.x << ' ' << event.gridPos.y << ' '
+            << (event.isLeftClick ? 'L' : 'R') << '\n';
+        break;
+
+    case InputEvent::Type::KeyPress:
+        m_file << "K " << event.keyCode << '\n';
+        break;
+    }
+}
+
+void InputRecorder::endFrame(float deltaTime) {
+    if (!m_file.is_open()) {
+        return;
+    }
+
+    m_elapsedTime += deltaTime;
+    m_file << "F " << m_frameIndex << ' ' << m_elapsedTime << ' ' << deltaTime << '\n';
+    ++m_frameIndex;
+}
+
+void InputRecorder::close() {
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+}
+
+InputPlayer::InputPlayer()
+    : m_nextFrame(0)
+    , m_gridWidth(0)
+    , m_gridHeight(0)
+{
+}
+
+bool InputPlayer::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error: Could not open input log '" << path << "'.\n";
+        return false;
+    }
+
+    // The header is a line of its own, so records are counted from line 2
+    std::string line;
+    std::getline(file, line);
+    std::istringstream header(line);
+
+    std::string magic;
+    int version = 0;
+    if (!(header >> magic >> version >> m_gridWidth >> m_gridHeight)
+        || magic != LOG_MAGIC || version < 1 || version > LOG_VERSION) {
+        std::cerr << "Error: '" << path << "' is not a version 1-" << LOG_VERSION << " input log.\n";
+        return false;
+    }
+
+    m_frames.clear();
+    m_nextFrame = 0;
+
+    InputFrame pending;
+    int lineNumber = 1;
+
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty()) {
+            continue;
+        }
+
+        std::istringstream record(line);
+        char tag = 0;
+        record >> tag;
+
+        bool valid = true;
+
+        if (tag == 'M' || tag == 'D') {
+            Vec2i pos;
+            char button = 0;
+            valid = static_cast<bool>(record >> pos.x >> pos.y >> button);
+            pending.events.push_back(tag == 'M'
+                ? InputEvent::mouseClick(pos, button == 'L')
+                : InputEvent::mouseDrag(pos, button == 'L'));
+        }
+        else if (tag == 'K') {
+            int keyCode = 0;
+            valid = static_cast<bool>(record >> keyCode);
+            pending.events.push_back(InputEvent::keyPress(keyCode));
+        }
+        else if (tag == 'F') {
+            unsigned long long frameIndex = 0;
+            double time = 0.0;
+            valid = static_cast<bool>(record >> frameIndex >> time >> pending.deltaTime);
+            m_frames.push_back(std::move(pending));
+            pending = InputFrame();
+        }
+        else {
+            valid = false;
+        }
+
+        if (!valid) {
+            std::cerr << "Error: Malformed record on line " << lineNumber << " of '" << path << "'.\n";
+            return false;
+        }
+    }
+
+    // Events after the last frame marker (e.g. the window was closed mid-frame)
+    if (!pending.events.empty()) {
+        m_frames.push_back(std::move(pending));
+    }
+
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Vec2i.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// A single user input, already translated to grid space
+struct InputEvent {
+    enum class Type {
+        MouseClick,
+        MouseDrag,      // Button held while entering another cell
+        KeyPress
+    };
+
+    Type type;
+    Vec2i gridPos;
+    bool isLeftClick;
+    int keyCode;
+
+    static InputEvent mouseClick(const Vec2i& gridPos, bool isLeftClick) {
+        return { Type::MouseClick, gridPos, isLeftClick, -1 };
+    }
+
+    static InputEvent mouseDrag(const Vec2i& gridPos, bool isLeftClick) {
+        return { Type::MouseDrag, gridPos, isLeftClick, -1 };
+    }
+
+    static InputEvent keyPress(int keyCode) {
+        return { Type::KeyPress, {}, false, keyCode };
+    }
+};
+
+// Everything that happened during one iteration of the main loop
+struct InputFrame {
+    float deltaTime = 0.0f;
+    std::vector<InputEvent> events;
+};
+
+// Writes input frames to a text log as they happen.
+//
+// Format, one record per line:
+//   pathfinding-input 2 <gridWidth> <gridHeight>   header
+//   M <x> <y> <L|R>                                 mouse click
+//   D <x> <y> <L|R>                                 mouse drag (version 2+)
+//   K <keyCode>                                     key press
+//   F <frame> <time> <deltaTime>                    end of frame
+// Events belong to the next F record that follows them.
+class InputRecorder {
+public:
+    InputRecorder();
+
+    bool open(const std::string& path, int gridWidth, int gridHeight);
+    bool isOpen() const { return m_file.is_open(); }
+
+    void recordEvent(const InputEvent& event);
+    void endFrame(float deltaTime);
+
+    void close();
+
+private:
+    std::ofstream m_file;
+    unsigned long long m_frameIndex;
+    double m_elapsedTime;
+};
+
+// Reads a log produced by InputRecorder back into memory
+class InputPlayer {
+public:
+    InputPlayer();
+
+    bool load(const std::string& path);
+
+    int getGridWidth() const { return m_gridWidth; }
+    int getGridHeight() const { return m_gridHeight; }
+
+    bool hasNextFrame() const { return m_nextFrame < m_frames.size(); }
+    const InputFrame& nextFrame() { return m_frames[m_nextFrame++]; }
+
+    size_t getFrameCount() const { return m_frames.size(); }
+
+private:
+    std::vector<InputFrame> m_frames;
+    size_t m_nextFrame;
+    int m_gridWidth;
+    int m_gridHeight;
+};
@@ -0,0 +1,279 @@
+#include "LoadGenerator.h"
+#include "LocalSocket.h"
+#include "PathProtocol.h"
+#include "Grid.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+    using LatencyClock = std::chrono::steady_clock;
+
+    struct Connection {
+        LocalSocket::Handle socket;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        size_t outputOffset;
+        int inFlight;
+    };
+
+    // Blocking request/response used once, before the connections go non-blocking
+    bool queryGridSize(LocalSocket::Handle socket, uint16_t gridId, int& width, int& height) {
+        using namespace PathProtocol;
+
+        std::vector<uint8_t> request;
+        Writer writer(request);
+        writer.beginMessage(MessageType::GridInfo, 0);
+        writer.writeU16(gridId);
+        writer.endMessage();
+
+        bool wouldBlock = false;
+        size_t sent = 0;
+        while (sent < request.size()) {
+            long long result = LocalSocket::send(socket, request.data() + sent, request.size() - sent, wouldBlock);
+            if (result <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(result);
+        }
+
+        std::vector<uint8_t> response;
+        uint8_t chunk[256];
+        size_t messageSize = 0;
+
+        while ((messageSize = completeMessageSize(response.data(), response.size())) == 0) {
+            long long received = LocalSocket::receive(socket, chunk, sizeof(chunk), wouldBlock);
+            if (received <= 0) {
+                return false;
+            }
+            response.insert(response.end(), chunk, chunk + received);
+        }
+
+        if (messageSize == SIZE_MAX) {
+            return false;
+        }
+
+        Reader reader(response.data() + LENGTH_PREFIX_SIZE, messageSize - LENGTH_PREFIX_SIZE);
+        auto type = static_cast<MessageType>(reader.readU8());
+        reader.readU32();
+        auto status = static_cast<Status>(reader.readU8());
+        width = reader.readI32();
+        height = reader.readI32();
+
+        return reader.ok() && type == MessageType::GridInfoResult && status == Status::Ok;
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+} // anonymous namespace
+
+LoadGenerator::LoadGenerator(const LoadGeneratorOptions& options)
+    : m_options(options)
+{
+}
+
+bool LoadGenerator::run() {
+    using namespace PathProtocol;
+
+    std::vector<Connection> connections;
+
+    for (int i = 0; i < std::max(m_options.connections, 1); ++i) {
+        LocalSocket::Handle socket = LocalSocket::connectTo(m_options.socketPath);
+        if (socket == LocalSocket::INVALID_HANDLE) {
+            std::cerr << "Error: Could not connect to '" << m_options.socketPath << "'.\n";
+            for (Connection& connection : connections) {
+                LocalSocket::close(connection.socket);
+            }
+            return false;
+        }
+        connections.push_back({ socket, {}, {}, 0, 0 });
+    }
+
+    int width = 0;
+    int height = 0;
+    if (!queryGridSize(connections[0].socket, m_options.gridId, width, height) || width <= 0 || height <= 0) {
+        std::cerr << "Error: Server has no grid " << m_options.gridId << ".\n";
+        for (Connection& connection : connections) {
+            LocalSocket::close(connection.socket);
+        }
+        return false;
+    }
+
+    for (Connection& connection : connections) {
+        LocalSocket::setNonBlocking(connection.socket);
+    }
+
+    std::mt19937 rng(m_options.seed);
+    std::uniform_int_distribution<int> randomX(0, width - 1);
+    std::uniform_int_distribution<int> randomY(0, height - 1);
+    std::uniform_int_distribution<int> randomPercent(0, 99);
+
+    const int totalRequests = std::max(m_options.totalRequests, 0);
+    const int pipelineDepth = std::max(m_options.pipelineDepth, 1);
+
+    // Request ids index straight into these
+    std::vector<LatencyClock::time_point> sendTimes(static_cast<size_t>(totalRequests));
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(static_cast<size_t>(totalRequests));
+
+    int issued = 0;
+    int completed = 0;
+    int noPath = 0;
+    bool failed = false;
+
+    std::vector<LocalSocket::PollEntry> pollSet(connections.size());
+    auto runStart = LatencyClock::now();
+
+    while (completed < totalRequests && !failed) {
+        // Top every connection up to the pipeline depth
+        for (Connection& connection : connections) {
+            Writer writer(connection.output);
+
+            while (connection.inFlight < pipelineDepth && issued < totalRequests) {
+                uint32_t requestId = static_cast<uint32_t>(issued);
+
+                if (randomPercent(rng) < m_options.editPercent) {
+                    writer.beginMessage(MessageType::EditCells, requestId);
+                    writer.writeU16(m_options.gridId);
+                    writer.writeU32(1);
+                    writer.writeI32(randomX(rng));
+                    writer.writeI32(randomY(rng));
+                    writer.writeU8(static_cast<uint8_t>(randomPercent(rng) < 30 ? CellType::Obstacle : CellType::Walkable));
+                }
+                else {
+                    writer.beginMessage(MessageType::FindPath, requestId);
+                    writer.writeU16(m_options.gridId);
+                    writer.writeU8(m_options.allowDiagonal ? FLAG_ALLOW_DIAGONAL : 0);
+                    writer.writeI32(randomX(rng));
+                    writer.writeI32(randomY(rng));
+                    writer.writeI32(randomX(rng));
+                    writer.writeI32(randomY(rng));
+                }
+                writer.endMessage();
+
+                sendTimes[requestId] = LatencyClock::now();
+                ++connection.inFlight;
+                ++issued;
+            }
+        }
+
+        for (size_t i = 0; i < connections.size(); ++i) {
+            short events = POLLIN;
+            if (connections[i].outputOffset < connections[i].output.size()) {
+                events |= POLLOUT;
+            }
+            pollSet[i] = { connections[i].socket, events, 0 };
+        }
+
+        if (LocalSocket::poll(pollSet.data(), pollSet.size(), 1000) <= 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < connections.size() && !failed; ++i) {
+            Connection& connection = connections[i];
+            bool wouldBlock = false;
+
+            if (pollSet[i].revents & POLLOUT) {
+                while (connection.outputOffset < connection.output.size()) {
+                    long long sent = LocalSocket::send(connection.socket,
+                        connection.output.data() + connection.outputOffset,
+                        connection.output.size() - connection.outputOffset, wouldBlock);
+                    if (sent <= 0) {
+                        failed = !wouldBlock;
+                        break;
+                    }
+                    connection.outputOffset += static_cast<size_t>(sent);
+                }
+
+                if (connection.outputOffset == connection.output.size()) {
+                    connection.output.clear();
+                    connection.outputOffset = 0;
+                }
+            }
+
+            if (!(pollSet[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+
+            uint8_t chunk[64 * 1024];
+            while (true) {
+                long long received = LocalSocket::receive(connection.socket, chunk, sizeof(chunk), wouldBlock);
+                if (received <= 0) {
+                    failed = !wouldBlock;
+                    break;
+                }
+                connection.input.insert(connection.input.end(), chunk, chunk + received);
+            }
+
+            auto now = LatencyClock::now();
+            size_t offset = 0;
+
+            while (true) {
+                size_t messageSize = completeMessageSize(connection.input.data() + offset, connection.input.size() - offset);
+                if (messageSize == 0) {
+                    break;
+                }
+                if (messageSize == SIZE_MAX) {
+                    failed = true;
+                    break;
+                }
+
+                Reader reader(connection.input.data() + offset + LENGTH_PREFIX_SIZE, messageSize - LENGTH_PREFIX_SIZE);
+                auto type = static_cast<MessageType>(reader.readU8());
+                uint32_t requestId = reader.readU32();
+                auto status = static_cast<Status>(reader.readU8());
+                offset += messageSize;
+
+                if (!reader.ok() || requestId >= sendTimes.size()) {
+                    failed = true;
+                    break;
+                }
+
+                if (type == MessageType::PathResult && status == Status::NoPath) {
+                    ++noPath;
+                }
+
+                std::chrono::duration<double, std::micro> latency = now - sendTimes[requestId];
+                latenciesUs.push_back(latency.count());
+                --connection.inFlight;
+                ++completed;
+            }
+
+            connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = LatencyClock::now() - runStart;
+
+    for (Connection& connection : connections) {
+        LocalSocket::close(connection.socket);
+    }
+
+    if (failed) {
+        std::cerr << "Error: Connection to the server failed after " << completed << " requests.\n";
+        return false;
+    }
+
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+
+    std::cout << "requests:           " << completed << '\n'
+              << "no path:            " << noPath << '\n'
+              << "elapsed (s):        " << elapsed.count() << '\n'
+              << "requests/s:         " << (elapsed.count() > 0.0 ? completed / elapsed.count() : 0.0) << '\n'
+              << "latency p50 (us):   " << percentile(latenciesUs, 0.50) << '\n'
+              << "latency p90 (us):   " << percentile(latenciesUs, 0.90) << '\n'
+              << "latency p99 (us):   " << percentile(latenciesUs, 0.99) << '\n'
+              << "latency p99.9 (us): " << percentile(latenciesUs, 0.999) << '\n'
+              << "latency max (us):   " << (latenciesUs.empty() ? 0.0 : latenciesUs.back()) << '\n';
+
+    return true;
+}
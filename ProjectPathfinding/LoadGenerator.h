@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+struct LoadGeneratorOptions {
+    std::string socketPath;
+    int connections = 4;
+
+    // Requests kept in flight per connection
+    int pipelineDepth = 32;
+
+    int totalRequests = 100000;
+
+    // Share of requests that are single-cell grid edits instead of path queries
+    int editPercent = 0;
+
+    uint16_t gridId = 0;
+    bool allowDiagonal = false;
+    unsigned seed = 1;
+};
+
+// Drives a PathServer with random path queries over several pipelined
+// connections, then reports throughput and latency percentiles
+class LoadGenerator {
+public:
+    explicit LoadGenerator(const LoadGeneratorOptions& options);
+
+    // Returns false if the server couldn't be reached or dropped a connection
+    bool run();
+
+private:
+    LoadGeneratorOptions m_options;
+};
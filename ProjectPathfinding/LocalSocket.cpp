@@ -0,0 +1,166 @@
+#include "LocalSocket.h"
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <afunix.h>
+#include <cstdio>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    bool fillAddress(const std::string& path, sockaddr_un& address) {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Error: Socket path '" << path << "' is too long.\n";
+            return false;
+        }
+
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+
+    bool lastErrorWouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+
+    // Broken pipes must come back as errors, not kill the process. Linux does
+    // this per send(), macOS per socket.
+#if defined(MSG_NOSIGNAL)
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    constexpr int SEND_FLAGS = 0;
+#endif
+
+    void disableSigPipe(LocalSocket::Handle socket) {
+#if defined(SO_NOSIGPIPE)
+        int enabled = 1;
+        ::setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#else
+        (void)socket;
+#endif
+    }
+
+} // anonymous namespace
+
+namespace LocalSocket {
+
+    bool initialize() {
+#ifdef _WIN32
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+        return true;
+#endif
+    }
+
+    Handle listenOn(const std::string& path) {
+        sockaddr_un address;
+        if (!fillAddress(path, address)) {
+            return INVALID_HANDLE;
+        }
+
+        Handle listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener == INVALID_HANDLE) {
+            return INVALID_HANDLE;
+        }
+
+#ifdef _WIN32
+        std::remove(path.c_str());
+#else
+        ::unlink(path.c_str());
+#endif
+
+        if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listener, SOMAXCONN) != 0
+            || !setNonBlocking(listener)) {
+            close(listener);
+            return INVALID_HANDLE;
+        }
+
+        return listener;
+    }
+
+    Handle connectTo(const std::string& path) {
+        sockaddr_un address;
+        if (!fillAddress(path, address)) {
+            return INVALID_HANDLE;
+        }
+
+        Handle socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket == INVALID_HANDLE) {
+            return INVALID_HANDLE;
+        }
+
+        if (::connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            close(socket);
+            return INVALID_HANDLE;
+        }
+
+        disableSigPipe(socket);
+        return socket;
+    }
+
+    Handle acceptClient(Handle listener) {
+        Handle client = ::accept(listener, nullptr, nullptr);
+        if (client != INVALID_HANDLE) {
+            disableSigPipe(client);
+        }
+        return client;
+    }
+
+    bool setNonBlocking(Handle socket) {
+#ifdef _WIN32
+        u_long enabled = 1;
+        return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+#else
+        int flags = ::fcntl(socket, F_GETFL, 0);
+        return flags >= 0 && ::fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    void close(Handle socket) {
+        if (socket == INVALID_HANDLE) {
+            return;
+        }
+#ifdef _WIN32
+        ::closesocket(socket);
+#else
+        ::close(socket);
+#endif
+    }
+
+    long long receive(Handle socket, void* buffer, size_t size, bool& wouldBlock) {
+        auto received = ::recv(socket, static_cast<char*>(buffer), static_cast<int>(size), 0);
+        wouldBlock = received < 0 && lastErrorWouldBlock();
+        return static_cast<long long>(received);
+    }
+
+    long long send(Handle socket, const void* buffer, size_t size, bool& wouldBlock) {
+        auto sent = ::send(socket, static_cast<const char*>(buffer), static_cast<int>(size), SEND_FLAGS);
+        wouldBlock = sent < 0 && lastErrorWouldBlock();
+        return static_cast<long long>(sent);
+    }
+
+    int poll(PollEntry* entries, size_t count, int timeoutMs) {
+#ifdef _WIN32
+        return ::WSAPoll(entries, static_cast<ULONG>(count), timeoutMs);
+#else
+        return ::poll(entries, static_cast<nfds_t>(count), timeoutMs);
+#endif
+    }
+
+} // namespace LocalSocket
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+// Thin portability layer over Unix domain stream sockets.
+// Windows 10+ supports AF_UNIX through Winsock, so the same code runs there.
+namespace LocalSocket {
+
+#ifdef _WIN32
+    using Handle = SOCKET;
+    using PollEntry = WSAPOLLFD;
+    inline const Handle INVALID_HANDLE = INVALID_SOCKET;
+#else
+    using Handle = int;
+    using PollEntry = pollfd;
+    inline constexpr Handle INVALID_HANDLE = -1;
+#endif
+
+    // Must be called once before any other function (no-op outside Windows)
+    bool initialize();
+
+    // Binds and listens on path, replacing any stale socket file left behind
+    Handle listenOn(const std::string& path);
+    Handle connectTo(const std::string& path);
+    Handle acceptClient(Handle listener);
+
+    bool setNonBlocking(Handle socket);
+    void close(Handle socket);
+
+    // Returns bytes transferred, 0 if the peer closed (receive only),
+    // or -1 on error. Would-block is reported as -1 with wouldBlock set.
+    long long receive(Handle socket, void* buffer, size_t size, bool& wouldBlock);
+    long long send(Handle socket, const void* buffer, size_t size, bool& wouldBlock);
+
+    int poll(PollEntry* entries, size_t count, int timeoutMs);
+
+} // namespace LocalSocket
@@ -0,0 +1,78 @@
+#pragma once
+#include "Grid.h"
+#include "Vec2i.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+// Movement rules shared by every search over a Grid, so all of them agree on
+// step costs, neighbor order and corner cutting
+namespace Movement {
+
+    // Integer-scaled costs preserve the sqrt(2) ratio without floating point
+    inline constexpr int CARDINAL_COST = 10;
+    inline constexpr int DIAGONAL_COST = 14;
+
+    inline constexpr Vec2i CARDINAL_DIRS[] = {
+        { 0, -1}, { 0, 1}, {-1, 0}, { 1, 0}
+    };
+
+    inline constexpr Vec2i DIAGONAL_DIRS[] = {
+        {-1, -1}, { 1, -1}, {-1, 1}, { 1, 1}
+    };
+
+    // Corner-cutting check: both adjacent cardinal cells must be walkable
+    // e.g. to move top-left, both "top" and "left" must be open
+    inline bool isDiagonalClear(const Grid& grid, const Vec2i& from, const Vec2i& dir) {
+        Vec2i adjacentA = { from.x + dir.x, from.y };
+        Vec2i adjacentB = { from.x, from.y + dir.y };
+        return grid.isWalkable(adjacentA) && grid.isWalkable(adjacentB);
+    }
+
+    // Calls visit(neighbor, stepCost) for every legal move out of pos
+    template <typename Visit>
+    void forEachNeighbor(const Grid& grid, const Vec2i& pos, bool allowDiagonal, Visit&& visit) {
+        for (const Vec2i& dir : CARDINAL_DIRS) {
+            Vec2i next = pos + dir;
+            if (grid.isWalkable(next)) {
+                visit(next, CARDINAL_COST);
+            }
+        }
+
+        if (!allowDiagonal) {
+            return;
+        }
+
+        for (const Vec2i& dir : DIAGONAL_DIRS) {
+            Vec2i next = pos + dir;
+            if (grid.isWalkable(next) && isDiagonalClear(grid, pos, dir)) {
+                visit(next, DIAGONAL_COST);
+            }
+        }
+    }
+
+    inline int manhattanDistance(const Vec2i& a, const Vec2i& b) {
+        return (std::abs(a.x - b.x) + std::abs(a.y - b.y)) * CARDINAL_COST;
+    }
+
+    inline int octileDistance(const Vec2i& a, const Vec2i& b) {
+        int dx = std::abs(a.x - b.x);
+        int dy = std::abs(a.y - b.y);
+        return CARDINAL_COST * (dx + dy) + (DIAGONAL_COST - 2 * CARDINAL_COST) * std::min(dx, dy);
+    }
+
+    inline int distance(const Vec2i& a, const Vec2i& b, bool allowDiagonal) {
+        return allowDiagonal ? octileDistance(a, b) : manhattanDistance(a, b);
+    }
+
+    // Summed step costs along a path of adjacent cells
+    inline int pathCost(const std::vector<Vec2i>& path) {
+        int cost = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            bool diagonal = path[i].x != path[i - 1].x && path[i].y != path[i - 1].y;
+            cost += diagonal ? DIAGONAL_COST : CARDINAL_COST;
+        }
+        return cost;
+    }
+
+} // namespace Movement
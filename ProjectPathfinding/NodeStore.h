@@ -0,0 +1,184 @@
+#pragma once
+#include "Vec2i.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Per-cell search state. The parent is stored as a position so a node can
+// be moved around by its store; the start node is its own parent.
+struct SearchNode {
+    int gCost;
+    int hCost;
+    Vec2i parent;
+    bool closed;
+};
+
+// Search state for every cell of the grid in flat arrays, indexed by
+// position. Stays allocated between searches: a generation stamp per cell
+// marks which entries belong to the current search, so reset() is O(1)
+// unless the grid size changed. Costs 24 bytes per cell for as long as it
+// is kept, so owners cap the grid size they use it for.
+class DenseNodeStore {
+public:
+    DenseNodeStore()
+        : m_width(0)
+        , m_generation(0)
+        , m_size(0)
+    {
+    }
+
+    void reset(int width, int height) {
+        const size_t cellCount = static_cast<size_t>(width) * height;
+        m_size = 0;
+
+        if (width != m_width || cellCount != m_nodes.size()) {
+            m_width = width;
+            m_nodes.assign(cellCount, SearchNode());
+            m_stamps.assign(cellCount, 0);
+            m_generation = 1;
+            return;
+        }
+
+        if (++m_generation == 0) {
+            std::fill(m_stamps.begin(), m_stamps.end(), 0);
+            m_generation = 1;
+        }
+    }
+
+    SearchNode* find(const Vec2i& pos) {
+        const size_t index = indexOf(pos);
+        return m_stamps[index] == m_generation ? &m_nodes[index] : nullptr;
+    }
+
+    // Only valid for positions not yet in the store
+    SearchNode& insert(const Vec2i& pos) {
+        const size_t index = indexOf(pos);
+        m_stamps[index] = m_generation;
+        ++m_size;
+        return m_nodes[index];
+    }
+
+    size_t size() const { return m_size; }
+
+    // Frees the arrays; the next reset() allocates them again
+    void release() {
+        m_width = 0;
+        m_size = 0;
+        std::vector<SearchNode>().swap(m_nodes);
+        std::vector<uint32_t>().swap(m_stamps);
+    }
+
+private:
+    int m_width;
+    uint32_t m_generation;
+    size_t m_size;
+    std::vector<SearchNode> m_nodes;
+    std::vector<uint32_t> m_stamps;
+
+    size_t indexOf(const Vec2i& pos) const {
+        return static_cast<size_t>(pos.y) * m_width + pos.x;
+    }
+};
+
+// Search state for only the cells a search touches, in a flat
+// open-addressing table with linear probing. Nodes live inline in the
+// slots, keyed on both coordinates packed into 64 bits and scattered by a
+// 64-bit mixer, so memory follows the size of the search rather than the
+// grid. The table doubles when half full, which moves nodes: pointers from
+// find() and insert() are only valid until the next insert().
+class SparseNodeStore {
+public:
+    SparseNodeStore()
+        : m_size(0)
+    {
+    }
+
+    // Empties the store, sized to hold expectedNodes without growing
+    void reset(size_t expectedNodes) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < expectedNodes * 2) {
+            capacity *= 2;
+        }
+
+        m_size = 0;
+        if (capacity != m_slots.size()) {
+            m_slots.assign(capacity, Slot());
+        }
+        else {
+            for (Slot& slot : m_slots) {
+                slot.key = EMPTY_KEY;
+            }
+        }
+    }
+
+    SearchNode* find(const Vec2i& pos) {
+        const uint64_t key = pos.packed();
+        const size_t mask = m_slots.size() - 1;
+
+        for (size_t i = mixBits(key) & mask; ; i = (i + 1) & mask) {
+            Slot& slot = m_slots[i];
+            if (slot.key == key) {
+                return &slot.node;
+            }
+            if (slot.key == EMPTY_KEY) {
+                return nullptr;
+            }
+        }
+    }
+
+    // Only valid for positions not yet in the store
+    SearchNode& insert(const Vec2i& pos) {
+        if ((m_size + 1) * 2 > m_slots.size()) {
+            grow();
+        }
+        ++m_size;
+        Slot& slot = findEmptySlot(pos.packed());
+        slot.key = pos.packed();
+        return slot.node;
+    }
+
+    size_t size() const { return m_size; }
+
+    // Slots allocated, used or not
+    size_t capacity() const { return m_slots.size(); }
+
+    // Frees the table; the next insert() or reset() allocates it again
+    void release() {
+        m_size = 0;
+        std::vector<Slot>().swap(m_slots);
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 256;
+
+    // Packed (-1, -1); never a cell of the grid
+    static constexpr uint64_t EMPTY_KEY = ~0ull;
+
+    struct Slot {
+        uint64_t key = EMPTY_KEY;
+        SearchNode node;
+    };
+
+    size_t m_size;
+    std::vector<Slot> m_slots;
+
+    Slot& findEmptySlot(uint64_t key) {
+        const size_t mask = m_slots.size() - 1;
+        size_t i = mixBits(key) & mask;
+        while (m_slots[i].key != EMPTY_KEY) {
+            i = (i + 1) & mask;
+        }
+        return m_slots[i];
+    }
+
+    void grow() {
+        std::vector<Slot> old(std::max(m_slots.size() * 2, MIN_CAPACITY));
+        old.swap(m_slots);
+
+        for (const Slot& slot : old) {
+            if (slot.key != EMPTY_KEY) {
+                findEmptySlot(slot.key) = slot;
+            }
+        }
+    }
+};
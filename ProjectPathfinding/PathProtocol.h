@@ -0,0 +1,141 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Wire format shared by PathServer and the load generator.
+//
+// Every message is a little-endian uint32 payload length followed by the
+// payload. Each payload starts with a uint8 message type and a uint32 request
+// id chosen by the client and echoed back in the response:
+//
+//   FindPath        u16 gridId, u8 flags (bit 0 = diagonal), i32 sx, sy, ex, ey
+//   EditCells       u16 gridId, u32 count, count x { i32 x, i32 y, u8 cellType }
+//   GridInfo        u16 gridId
+//
+//   PathResult      u8 status, u32 count, count x { i32 x, i32 y }
+//   EditResult      u8 status
+//   GridInfoResult  u8 status, i32 width, i32 height
+//
+// EditCells is all or nothing: if any edit is out of bounds or names an
+// unknown cell type, the answer is BadRequest and the grid is unchanged.
+//
+// Responses on a connection arrive in the order the requests were sent, so
+// clients may pipeline as many requests as they like.
+namespace PathProtocol {
+
+    enum class MessageType : uint8_t {
+        FindPath = 1,
+        EditCells = 2,
+        GridInfo = 3,
+
+        PathResult = 0x81,
+        EditResult = 0x82,
+        GridInfoResult = 0x83
+    };
+
+    enum class Status : uint8_t {
+        Ok = 0,
+        NoPath = 1,
+        UnknownGrid = 2,
+        BadRequest = 3
+    };
+
+    inline constexpr uint8_t FLAG_ALLOW_DIAGONAL = 1;
+
+    // Anything larger is treated as a corrupt stream
+    inline constexpr uint32_t MAX_PAYLOAD_SIZE = 16u << 20;
+
+    inline constexpr size_t LENGTH_PREFIX_SIZE = 4;
+
+    // Appends little-endian fields to a byte buffer
+    class Writer {
+    public:
+        explicit Writer(std::vector<uint8_t>& buffer) : m_buffer(buffer), m_messageStart(0) {}
+
+        // Reserves the length prefix; endMessage() fills it in
+        void beginMessage(MessageType type, uint32_t requestId) {
+            m_messageStart = m_buffer.size();
+            m_buffer.resize(m_buffer.size() + LENGTH_PREFIX_SIZE);
+            writeU8(static_cast<uint8_t>(type));
+            writeU32(requestId);
+        }
+
+        void endMessage() {
+            uint32_t payloadSize = static_cast<uint32_t>(m_buffer.size() - m_messageStart - LENGTH_PREFIX_SIZE);
+            for (size_t i = 0; i < LENGTH_PREFIX_SIZE; ++i) {
+                m_buffer[m_messageStart + i] = static_cast<uint8_t>(payloadSize >> (8 * i));
+            }
+        }
+
+        void writeU8(uint8_t value) { m_buffer.push_back(value); }
+        void writeU16(uint16_t value) { writeLittleEndian(value, 2); }
+        void writeU32(uint32_t value) { writeLittleEndian(value, 4); }
+        void writeI32(int32_t value) { writeLittleEndian(static_cast<uint32_t>(value), 4); }
+
+    private:
+        std::vector<uint8_t>& m_buffer;
+        size_t m_messageStart;
+
+        void writeLittleEndian(uint32_t value, size_t bytes) {
+            for (size_t i = 0; i < bytes; ++i) {
+                m_buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+    };
+
+    // Reads little-endian fields from one payload. Reads past the end fail
+    // and latch the reader into an error state, checked once with ok().
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0), m_ok(true) {}
+
+        uint8_t readU8() { return static_cast<uint8_t>(readLittleEndian(1)); }
+        uint16_t readU16() { return static_cast<uint16_t>(readLittleEndian(2)); }
+        uint32_t readU32() { return readLittleEndian(4); }
+        int32_t readI32() { return static_cast<int32_t>(readLittleEndian(4)); }
+
+        bool ok() const { return m_ok; }
+        size_t remaining() const { return m_size - m_offset; }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_offset;
+        bool m_ok;
+
+        uint32_t readLittleEndian(size_t bytes) {
+            if (!m_ok || m_size - m_offset < bytes) {
+                m_ok = false;
+                return 0;
+            }
+
+            uint32_t value = 0;
+            for (size_t i = 0; i < bytes; ++i) {
+                value |= static_cast<uint32_t>(m_data[m_offset + i]) << (8 * i);
+            }
+            m_offset += bytes;
+            return value;
+        }
+    };
+
+    // Size of the first complete message in data (prefix included), 0 if
+    // more bytes are needed, or SIZE_MAX if the length prefix is invalid
+    inline size_t completeMessageSize(const uint8_t* data, size_t size) {
+        if (size < LENGTH_PREFIX_SIZE) {
+            return 0;
+        }
+
+        uint32_t payloadSize = 0;
+        for (size_t i = 0; i < LENGTH_PREFIX_SIZE; ++i) {
+            payloadSize |= static_cast<uint32_t>(data[i]) << (8 * i);
+        }
+
+        if (payloadSize == 0 || payloadSize > MAX_PAYLOAD_SIZE) {
+            return SIZE_MAX;
+        }
+
+        size_t total = LENGTH_PREFIX_SIZE + payloadSize;
+        return size >= total ? total : 0;
+    }
+
+} // namespace PathProtocol
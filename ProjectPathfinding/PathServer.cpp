@@ -0,0 +1,382 @@
+#include "PathServer.h"
+#include "PathProtocol.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+    // Wake up regularly so requestStop() is noticed even when idle
+    constexpr int POLL_TIMEOUT_MS = 100;
+
+    constexpr size_t RECEIVE_CHUNK_SIZE = 64 * 1024;
+
+    // x, y and cell type of one edit on the wire
+    constexpr size_t EDIT_WIRE_SIZE = 9;
+
+    bool isValidCellType(uint8_t value) {
+        return value <= static_cast<uint8_t>(CellType::End);
+    }
+
+} // anonymous namespace
+
+PathServer::PathServer(unsigned workerCount)
+    : m_workers(workerCount)
+    , m_pathfinders(m_workers.getWorkerCount())
+    , m_listener(LocalSocket::INVALID_HANDLE)
+    , m_stopRequested(false)
+    , m_queriesServed(0)
+{
+}
+
+PathServer::~PathServer() {
+    for (Client& client : m_clients) {
+        LocalSocket::close(client.socket);
+    }
+
+    if (m_listener != LocalSocket::INVALID_HANDLE) {
+        LocalSocket::close(m_listener);
+        std::remove(m_socketPath.c_str());
+    }
+}
+
+int PathServer::addGrid(int width, int height) {
+    m_grids.push_back(std::make_unique<Grid>(width, height));
+    return static_cast<int>(m_grids.size()) - 1;
+}
+
+bool PathServer::listen(const std::string& socketPath) {
+    m_listener = LocalSocket::listenOn(socketPath);
+    if (m_listener == LocalSocket::INVALID_HANDLE) {
+        std::cerr << "Error: Could not listen on '" << socketPath << "'.\n";
+        return false;
+    }
+
+    m_socketPath = socketPath;
+    return true;
+}
+
+void PathServer::run() {
+    std::vector<LocalSocket::PollEntry> pollSet;
+
+    while (!m_stopRequested.load()) {
+        pollSet.clear();
+        pollSet.push_back({ m_listener, POLLIN, 0 });
+
+        for (const Client& client : m_clients) {
+            short events = client.hungUp ? 0 : POLLIN;
+            if (client.outputOffset < client.output.size()) {
+                events |= POLLOUT;
+            }
+            pollSet.push_back({ client.socket, events, 0 });
+        }
+
+        // Interrupted or timed out: just go round again and recheck the stop flag
+        if (LocalSocket::poll(pollSet.data(), pollSet.size(), POLL_TIMEOUT_MS) <= 0) {
+            continue;
+        }
+
+        // Clients accepted now are appended, so pollSet still lines up with
+        // the clients that were polled
+        const size_t polledClients = pollSet.size() - 1;
+
+        if (pollSet[0].revents & POLLIN) {
+            acceptClients();
+        }
+
+        for (size_t i = 0; i < polledClients; ++i) {
+            short revents = pollSet[i + 1].revents;
+
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                readClient(i);
+            }
+            if ((revents & POLLOUT) && !m_clients[i].closed) {
+                flushClient(m_clients[i]);
+            }
+        }
+
+        processBatch();
+        removeClosedClients();
+    }
+
+    std::cout << "Served " << m_queriesServed << " path queries.\n";
+}
+
+void PathServer::acceptClients() {
+    while (true) {
+        LocalSocket::Handle socket = LocalSocket::acceptClient(m_listener);
+        if (socket == LocalSocket::INVALID_HANDLE) {
+            return;
+        }
+
+        if (!LocalSocket::setNonBlocking(socket)) {
+            LocalSocket::close(socket);
+            continue;
+        }
+
+        m_clients.push_back({ socket, {}, {}, 0, false, false });
+    }
+}
+
+void PathServer::readClient(size_t clientIndex) {
+    Client& client = m_clients[clientIndex];
+    if (client.closed || client.hungUp) {
+        return;
+    }
+
+    uint8_t chunk[RECEIVE_CHUNK_SIZE];
+
+    while (true) {
+        bool wouldBlock = false;
+        long long received = LocalSocket::receive(client.socket, chunk, sizeof(chunk), wouldBlock);
+
+        if (received > 0) {
+            client.input.insert(client.input.end(), chunk, chunk + received);
+            continue;
+        }
+
+        // Orderly shutdown or a real error. Requests that arrived complete
+        // before it are still answered; the client may only have shut down
+        // its sending side and be waiting to read them.
+        if (!wouldBlock) {
+            client.hungUp = true;
+        }
+        break;
+    }
+
+    parseMessages(clientIndex);
+}
+
+void PathServer::parseMessages(size_t clientIndex) {
+    using namespace PathProtocol;
+
+    Client& client = m_clients[clientIndex];
+    size_t offset = 0;
+
+    while (true) {
+        size_t messageSize = completeMessageSize(client.input.data() + offset, client.input.size() - offset);
+        if (messageSize == 0) {
+            break;
+        }
+
+        // A corrupt stream can't be resynchronized, so drop the connection
+        if (messageSize == SIZE_MAX) {
+            client.closed = true;
+            return;
+        }
+
+        Reader reader(client.input.data() + offset + LENGTH_PREFIX_SIZE, messageSize - LENGTH_PREFIX_SIZE);
+        offset += messageSize;
+
+        Request request;
+        request.client = clientIndex;
+        request.type = reader.readU8();
+        request.requestId = reader.readU32();
+        request.gridId = reader.readU16();
+        request.allowDiagonal = false;
+        request.invalid = false;
+
+        switch (static_cast<MessageType>(request.type)) {
+        case MessageType::FindPath:
+            request.allowDiagonal = (reader.readU8() & FLAG_ALLOW_DIAGONAL) != 0;
+            request.start.x = reader.readI32();
+            request.start.y = reader.readI32();
+            request.end.x = reader.readI32();
+            request.end.y = reader.readI32();
+            break;
+
+        case MessageType::EditCells:
+        {
+            uint32_t count = reader.readU32();
+            if (count > reader.remaining() / EDIT_WIRE_SIZE) {
+                client.closed = true;
+                return;
+            }
+
+            request.edits.resize(count);
+            for (CellEdit& edit : request.edits) {
+                edit.pos.x = reader.readI32();
+                edit.pos.y = reader.readI32();
+
+                uint8_t type = reader.readU8();
+                edit.type = static_cast<CellType>(type);
+                request.invalid = request.invalid || !isValidCellType(type);
+            }
+            break;
+        }
+
+        case MessageType::GridInfo:
+            break;
+
+        default:
+            client.closed = true;
+            return;
+        }
+
+        if (!reader.ok()) {
+            client.closed = true;
+            return;
+        }
+
+        m_batch.push_back(std::move(request));
+    }
+
+    client.input.erase(client.input.begin(), client.input.begin() + offset);
+}
+
+void PathServer::processBatch() {
+    using namespace PathProtocol;
+
+    size_t index = 0;
+
+    while (index < m_batch.size()) {
+        auto type = static_cast<MessageType>(m_batch[index].type);
+
+        if (type == MessageType::FindPath) {
+            // Consecutive queries see the same grid state, so they can all run at once
+            size_t runEnd = index;
+            while (runEnd < m_batch.size()
+                && static_cast<MessageType>(m_batch[runEnd].type) == MessageType::FindPath) {
+                ++runEnd;
+            }
+
+            solveQueries(index, runEnd);
+            index = runEnd;
+        }
+        else if (type == MessageType::EditCells) {
+            applyEdits(m_batch[index]);
+            ++index;
+        }
+        else {
+            Request& request = m_batch[index];
+            const Grid* grid = findGrid(request.gridId);
+
+            Writer writer(request.response);
+            writer.beginMessage(MessageType::GridInfoResult, request.requestId);
+            writer.writeU8(static_cast<uint8_t>(grid ? Status::Ok : Status::UnknownGrid));
+            writer.writeI32(grid ? grid->getWidth() : 0);
+            writer.writeI32(grid ? grid->getHeight() : 0);
+            writer.endMessage();
+            ++index;
+        }
+    }
+
+    // Requests were batched in arrival order, so responses stay in order per client
+    for (Request& request : m_batch) {
+        Client& client = m_clients[request.client];
+        if (!client.closed) {
+            client.output.insert(client.output.end(), request.response.begin(), request.response.end());
+        }
+    }
+    m_batch.clear();
+
+    for (Client& client : m_clients) {
+        if (!client.closed && client.outputOffset < client.output.size()) {
+            flushClient(client);
+        }
+    }
+}
+
+void PathServer::solveQueries(size_t begin, size_t end) {
+    using namespace PathProtocol;
+
+    m_workers.parallelFor(end - begin, [&](size_t first, size_t last, unsigned worker) {
+        Pathfinder& pathfinder = m_pathfinders[worker];
+
+        for (size_t i = begin + first; i < begin + last; ++i) {
+            Request& request = m_batch[i];
+            const Grid* grid = findGrid(request.gridId);
+
+            std::vector<Vec2i> path;
+            Status status = Status::UnknownGrid;
+
+            if (grid) {
+                pathfinder.setAllowDiagonal(request.allowDiagonal);
+                path = pathfinder.findPath(*grid, request.start, request.end);
+                status = path.empty() ? Status::NoPath : Status::Ok;
+            }
+
+            Writer writer(request.response);
+            writer.beginMessage(MessageType::PathResult, request.requestId);
+            writer.writeU8(static_cast<uint8_t>(status));
+            writer.writeU32(static_cast<uint32_t>(path.size()));
+            for (const Vec2i& pos : path) {
+                writer.writeI32(pos.x);
+                writer.writeI32(pos.y);
+            }
+            writer.endMessage();
+        }
+    });
+
+    m_queriesServed += end - begin;
+}
+
+void PathServer::applyEdits(Request& request) {
+    using namespace PathProtocol;
+
+    Grid* grid = findGrid(request.gridId);
+    Status status = grid ? Status::Ok : Status::UnknownGrid;
+
+    // A request is applied whole or not at all, so check every edit first
+    if (grid && (request.invalid || std::any_of(request.edits.begin(), request.edits.end(),
+        [grid](const CellEdit& edit) { return !grid->isInBounds(edit.pos); }))) {
+        status = Status::BadRequest;
+    }
+
+    if (status == Status::Ok) {
+        // One version bump per request, however many cells it touches
+        grid->beginEdit();
+        for (const CellEdit& edit : request.edits) {
+            grid->setCellType(edit.pos, edit.type);
+        }
+        grid->commitEdit();
+    }
+
+    Writer writer(request.response);
+    writer.beginMessage(MessageType::EditResult, request.requestId);
+    writer.writeU8(static_cast<uint8_t>(status));
+    writer.endMessage();
+}
+
+void PathServer::flushClient(Client& client) {
+    while (client.outputOffset < client.output.size()) {
+        bool wouldBlock = false;
+        long long sent = LocalSocket::send(client.socket, client.output.data() + client.outputOffset,
+            client.output.size() - client.outputOffset, wouldBlock);
+
+        if (sent > 0) {
+            client.outputOffset += static_cast<size_t>(sent);
+            continue;
+        }
+
+        // Kernel buffer is full: the rest goes out when poll reports POLLOUT
+        if (!wouldBlock) {
+            client.closed = true;
+        }
+        break;
+    }
+
+    if (client.outputOffset == client.output.size()) {
+        client.output.clear();
+        client.outputOffset = 0;
+    }
+}
+
+void PathServer::removeClosedClients() {
+    for (Client& client : m_clients) {
+        // A hung-up client leaves once everything owed to it is sent
+        if (client.hungUp && client.outputOffset == client.output.size()) {
+            client.closed = true;
+        }
+        if (client.closed) {
+            LocalSocket::close(client.socket);
+        }
+    }
+
+    m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+        [](const Client& client) { return client.closed; }), m_clients.end());
+}
+
+Grid* PathServer::findGrid(uint16_t gridId) const {
+    return gridId < m_grids.size() ? m_grids[gridId].get() : nullptr;
+}
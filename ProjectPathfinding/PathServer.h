@@ -0,0 +1,95 @@
+#pragma once
+#include "Grid.h"
+#include "LocalSocket.h"
+#include "Pathfinder.h"
+#include "ThreadPool.h"
+#include "Vec2i.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Headless path query service over a Unix domain socket (see PathProtocol.h).
+//
+// Keeps its grids resident and serves any number of clients from a single
+// poll loop. Everything that arrives in one poll cycle becomes one batch:
+// runs of path queries are solved in parallel on the worker pool, and grid
+// edits are applied between them in arrival order, so every query sees
+// exactly the edits sent before it.
+class PathServer {
+public:
+    // 0 picks one worker per hardware thread
+    explicit PathServer(unsigned workerCount = 0);
+    ~PathServer();
+
+    // Returns the new grid's id
+    int addGrid(int width, int height);
+
+    bool listen(const std::string& socketPath);
+
+    // Serves until requestStop() is called
+    void run();
+
+    // Safe to call from another thread or a signal handler
+    void requestStop() { m_stopRequested.store(true); }
+
+private:
+    struct Client {
+        LocalSocket::Handle socket;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        size_t outputOffset;
+        bool closed;
+
+        // Sent nothing more after this; closed once its responses are out
+        bool hungUp;
+    };
+
+    struct CellEdit {
+        Vec2i pos;
+        CellType type;
+    };
+
+    struct Request {
+        size_t client;
+        uint32_t requestId;
+        uint8_t type;
+        uint16_t gridId;
+        bool allowDiagonal;
+        Vec2i start;
+        Vec2i end;
+        std::vector<CellEdit> edits;
+        std::vector<uint8_t> response;
+
+        // Well formed on the wire, but carrying a value the server can't
+        // accept, such as an unknown cell type. Answered with BadRequest.
+        bool invalid;
+    };
+
+    ThreadPool m_workers;
+
+    // One per worker, since Pathfinder keeps per-search state
+    std::vector<Pathfinder> m_pathfinders;
+
+    std::vector<std::unique_ptr<Grid>> m_grids;
+
+    LocalSocket::Handle m_listener;
+    std::string m_socketPath;
+    std::vector<Client> m_clients;
+    std::vector<Request> m_batch;
+    std::atomic<bool> m_stopRequested;
+
+    unsigned long long m_queriesServed;
+
+    void acceptClients();
+    void readClient(size_t clientIndex);
+    void parseMessages(size_t clientIndex);
+    void processBatch();
+    void solveQueries(size_t begin, size_t end);
+    void applyEdits(Request& request);
+    void flushClient(Client& client);
+    void removeClosedClients();
+
+    Grid* findGrid(uint16_t gridId) const;
+};
@@ -1,93 +1,278 @@
 #include "Pathfinder.h"
+#include "FirstMoveTable.h"
+#include "Movement.h"
+#include "SubgoalGraph.h"
 #include <queue>
-#include <unordered_map>
 #include <algorithm>
-#include <memory>
+#include <cmath>
+#include <cstdlib>
 
 namespace {
 
-    struct PathNode {
-        Vec2i pos;
-        int gCost;
+    // Open set entries carry a snapshot of the costs they were pushed with.
+    // Relaxing a node pushes a fresh entry rather than editing one already in
+    // the heap, which would silently break the heap ordering. Entries name
+    // their node by position, since a SparseNodeStore may move it.
+    struct OpenEntry {
+        int fCost;
         int hCost;
-        PathNode* parent;
-
-        PathNode(const Vec2i& pos)
-            : pos(pos), gCost(0), hCost(0), parent(nullptr)
-        {
-        }
-
-        int getFCost() const { return gCost + hCost; }
+        Vec2i pos;
     };
 
-    struct ComparePathNode {
-        bool operator()(const PathNode* a, const PathNode* b) const {
-            int fA = a->getFCost();
-            int fB = b->getFCost();
-
-            if (fA == fB) {
-                return a->hCost > b->hCost;
+    struct CompareOpenEntry {
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const {
+            if (a.fCost == b.fCost) {
+                return a.hCost > b.hCost;
             }
-            return fA > fB;
+            return a.fCost > b.fCost;
         }
     };
 
-    constexpr Vec2i CARDINAL_DIRS[] = {
-        { 0, -1}, { 0, 1}, {-1, 0}, { 1, 0}
-    };
+    template <typename NodeStore>
+    std::vector<Vec2i> reconstructPath(NodeStore& nodes, const Vec2i& goal) {
+        Vec2i pos = goal;
+        std::vector<Vec2i> path = { pos };
 
-    constexpr Vec2i DIAGONAL_DIRS[] = {
-        {-1, -1}, { 1, -1}, {-1, 1}, { 1, 1}
-    };
+        // Walk back to the start, which is its own parent
+        while (nodes.find(pos)->parent != pos) {
+            pos = nodes.find(pos)->parent;
+            path.push_back(pos);
+        }
 
-    // Attempts to expand a neighbor node. If the neighbor is new, it's created
-    // and added to the open set. If it already exists with a higher g-cost,
-    // its cost is relaxed and it's re-added to the open set.
-    void expandNeighbor(
-        const Vec2i& neighborPos,
-        int newGCost,
-        int hCost,
-        PathNode* parent,
-        std::priority_queue<PathNode*, std::vector<PathNode*>, ComparePathNode>& openSet,
-        std::vector<std::unique_ptr<PathNode>>& allNodes,
-        std::unordered_map<Vec2i, PathNode*>& nodeMap)
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Core A* loop shared by every query. Settles nodes in f-cost order and
+    // collects a path each time a goal cell is settled, stopping once
+    // maxGoals goals have been found or the open set runs dry.
+    // With reopenClosed, a closed node reached more cheaply is evaluated
+    // again, which inconsistent (e.g. dynamically weighted) heuristics need
+    // to keep their suboptimality bound.
+    template <typename NodeStore, typename Heuristic, typename IsGoal>
+    std::vector<std::vector<Vec2i>> runSearch(const Grid& grid, const Vec2i& start,
+        bool allowDiagonal, Heuristic heuristic, IsGoal isGoal, size_t maxGoals,
+        bool reopenClosed, NodeStore& nodes, SearchStats& stats)
     {
-        auto it = nodeMap.find(neighborPos);
-
-        if (it != nodeMap.end()) {
-            // Node already discovered  relax if we found a cheaper path
-            PathNode* existing = it->second;
-            if (newGCost < existing->gCost) {
-                existing->gCost = newGCost;
-                existing->parent = parent;
-                openSet.push(existing);
+        std::vector<std::vector<Vec2i>> paths;
+
+        // Open set: nodes to evaluate, sorted by lowest f-cost
+        std::priority_queue<OpenEntry, std::vector<OpenEntry>, CompareOpenEntry> openSet;
+
+        // Seed the open set with the start node
+        SearchNode& startNode = nodes.insert(start);
+        startNode = { 0, heuristic(start), start, false };
+        openSet.push({ startNode.hCost, startNode.hCost, start });
+
+        while (!openSet.empty()) {
+            // Pick the node with the lowest f-cost
+            OpenEntry entry = openSet.top();
+            openSet.pop();
+
+            // Skip stale entries (node was already evaluated, or has since
+            // been pushed again with a cheaper cost)
+            SearchNode* current = nodes.find(entry.pos);
+            if (current->closed || entry.fCost != current->gCost + current->hCost) {
+                continue;
+            }
+
+            current->closed = true;
+
+            // Goal reached \x97 record its path, and keep going if more are wanted
+            if (isGoal(entry.pos)) {
+                paths.push_back(reconstructPath(nodes, entry.pos));
+                if (paths.size() >= maxGoals) {
+                    break;
+                }
             }
+
+            ++stats.nodesExpanded;
+
+            // Inserting neighbors may move 'current', so keep what's needed
+            const Vec2i pos = entry.pos;
+            const int gCost = current->gCost;
+
+            Movement::forEachNeighbor(grid, pos, allowDiagonal, [&](const Vec2i& next, int stepCost) {
+                const int newGCost = gCost + stepCost;
+                SearchNode* node = nodes.find(next);
+
+                // New node \x97 create and add to open set
+                if (!node) {
+                    SearchNode& created = nodes.insert(next);
+                    created = { newGCost, heuristic(next), pos, false };
+                    openSet.push({ newGCost + created.hCost, created.hCost, next });
+                    return;
+                }
+
+                if (node->closed && !reopenClosed) {
+                    return;
+                }
+
+                // Node already discovered \x97 relax if we found a cheaper path
+                if (newGCost < node->gCost) {
+                    node->gCost = newGCost;
+                    node->parent = pos;
+                    node->closed = false;
+                    openSet.push({ newGCost + node->hCost, node->hCost, next });
+                }
+            });
         }
-        else {
-            // New node  create and add to open set
-            auto node = std::make_unique<PathNode>(neighborPos);
-            node->gCost = newGCost;
-            node->hCost = hCost;
-            node->parent = parent;
-
-            PathNode* nodePtr = node.get();
-            nodeMap[neighborPos] = nodePtr;
-            allNodes.push_back(std::move(node));
-            openSet.push(nodePtr);
+
+        stats.nodesGenerated = static_cast<int>(nodes.size());
+        return paths;
+    }
+
+    // Cells a search between two corners is expected to touch: their
+    // bounding box, padded on every side by half its longer edge to allow
+    // for detours around obstacles
+    size_t expectedSearchArea(const Vec2i& a, const Vec2i& b) {
+        const int width = std::abs(a.x - b.x) + 1;
+        const int height = std::abs(a.y - b.y) + 1;
+        const int margin = std::max(width, height) / 2 + 8;
+        return static_cast<size_t>(width + 2 * margin) * (height + 2 * margin);
+    }
+
+    // Distance between two cells with every step costing the given amounts
+    // instead of the usual 10 and 14
+    int scaledDistance(const Vec2i& a, const Vec2i& b, bool allowDiagonal,
+        int cardinalCost, int diagonalCost)
+    {
+        const int dx = std::abs(a.x - b.x);
+        const int dy = std::abs(a.y - b.y);
+        if (!allowDiagonal) {
+            return cardinalCost * (dx + dy);
         }
+        return cardinalCost * (dx + dy) + (diagonalCost - 2 * cardinalCost) * std::min(dx, dy);
     }
 
-    std::vector<Vec2i> reconstructPath(const PathNode* goalNode) {
-        std::vector<Vec2i> path;
-        const PathNode* current = goalNode;
+    // Focal entries prefer the node nearest the goal, then the lower f-cost
+    struct CompareFocalEntry {
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const {
+            if (a.hCost == b.hCost) {
+                return a.fCost > b.fCost;
+            }
+            return a.hCost > b.hCost;
+        }
+    };
+
+    // A*-epsilon. OPEN is split at the focal bound (1 + epsilon) * fmin: nodes
+    // under it are FOCAL and sit in two heaps, one by distance to the goal to
+    // pick the next node and one by f-cost to track fmin; the rest wait in a
+    // heap by f-cost and are moved over as fmin rises. Since fmin never
+    // exceeds the optimal cost, any goal taken from FOCAL is within the
+    // bound. Like runSearch, entries are never updated in place: stale ones
+    // are recognised by their f-cost and skipped wherever they surface.
+    template <typename NodeStore>
+    std::vector<Vec2i> runFocalSearch(const Grid& grid, const Vec2i& start, const Vec2i& end,
+        bool allowDiagonal, float epsilon, NodeStore& nodes, SearchStats& stats)
+    {
+        using CostHeap = std::priority_queue<OpenEntry, std::vector<OpenEntry>, CompareOpenEntry>;
+        CostHeap outsideFocal;
+        CostHeap focalByCost;
+        std::priority_queue<OpenEntry, std::vector<OpenEntry>, CompareFocalEntry> focal;
+
+        const double weight = 1.0 + epsilon;
+        int focalBound = -1;
+
+        auto isCurrent = [&](const OpenEntry& entry) {
+            const SearchNode* node = nodes.find(entry.pos);
+            return !node->closed && entry.fCost == node->gCost + node->hCost;
+        };
+
+        auto open = [&](const OpenEntry& entry) {
+            if (entry.fCost <= focalBound) {
+                focal.push(entry);
+                focalByCost.push(entry);
+            }
+            else {
+                outsideFocal.push(entry);
+            }
+        };
+
+        SearchNode& startNode = nodes.insert(start);
+        startNode = { 0, Movement::distance(start, end, allowDiagonal), start, false };
+        open({ startNode.hCost, startNode.hCost, start });
+
+        while (true) {
+            while (!focalByCost.empty() && !isCurrent(focalByCost.top())) {
+                focalByCost.pop();
+            }
+            while (!outsideFocal.empty() && !isCurrent(outsideFocal.top())) {
+                outsideFocal.pop();
+            }
+
+            // Everything outside FOCAL costs more than anything in it
+            int fMin;
+            if (!focalByCost.empty()) {
+                fMin = focalByCost.top().fCost;
+            }
+            else if (!outsideFocal.empty()) {
+                fMin = outsideFocal.top().fCost;
+            }
+            else {
+                break;
+            }
+
+            // Widen FOCAL to the new bound once the best f-cost has risen
+            int newBound = static_cast<int>(std::floor(fMin * weight));
+            if (newBound > focalBound) {
+                focalBound = newBound;
+                while (!outsideFocal.empty() && outsideFocal.top().fCost <= focalBound) {
+                    OpenEntry moved = outsideFocal.top();
+                    outsideFocal.pop();
+                    if (isCurrent(moved)) {
+                        focal.push(moved);
+                        focalByCost.push(moved);
+                    }
+                }
+            }
+
+            OpenEntry entry = focal.top();
+            focal.pop();
+            if (!isCurrent(entry)) {
+                continue;
+            }
+
+            SearchNode* current = nodes.find(entry.pos);
+            current->closed = true;
+
+            if (entry.pos == end) {
+                stats.nodesGenerated = static_cast<int>(nodes.size());
+                return reconstructPath(nodes, end);
+            }
+
+            ++stats.nodesExpanded;
 
-        while (current != nullptr) {
-            path.push_back(current->pos);
-            current = current->parent;
+            // Inserting neighbors may move 'current', so keep what's needed
+            const Vec2i pos = entry.pos;
+            const int gCost = current->gCost;
+
+            // Closed nodes are reopened when reached more cheaply, otherwise
+            // fmin could overshoot the optimal cost and void the bound
+            Movement::forEachNeighbor(grid, pos, allowDiagonal, [&](const Vec2i& next, int stepCost) {
+                const int newGCost = gCost + stepCost;
+                SearchNode* node = nodes.find(next);
+
+                if (!node) {
+                    SearchNode& created = nodes.insert(next);
+                    created = { newGCost, Movement::distance(next, end, allowDiagonal), pos, false };
+                    open({ newGCost + created.hCost, created.hCost, next });
+                    return;
+                }
+
+                if (newGCost >= node->gCost) {
+                    return;
+                }
+
+                node->gCost = newGCost;
+                node->parent = pos;
+                node->closed = false;
+                open({ newGCost + node->hCost, node->hCost, next });
+            });
         }
 
-        std::reverse(path.begin(), path.end());
-        return path;
+        stats.nodesGenerated = static_cast<int>(nodes.size());
+        return {};
     }
 
 } // anonymous namespace
@@ -97,107 +282,259 @@ Pathfinder::Pathfinder()
 {
 }
 
+template <typename Run>
+auto Pathfinder::withNodeStore(const Grid& grid, size_t expectedNodes, SearchStats& stats, Run run) {
+    const size_t cellCount = static_cast<size_t>(grid.getWidth()) * grid.getHeight();
+
+    if (expectedNodes < cellCount / SPARSE_AREA_DIVISOR || cellCount > MAX_DENSE_CELLS) {
+        stats.sparseState = true;
+        m_sparseNodes.reset(std::min(expectedNodes, MAX_DENSE_CELLS));
+        auto result = run(m_sparseNodes);
+
+        if (m_sparseNodes.capacity() > MAX_DENSE_CELLS) {
+            m_sparseNodes.release();
+        }
+        return result;
+    }
+
+    m_denseNodes.reset(grid.getWidth(), grid.getHeight());
+    return run(m_denseNodes);
+}
+
+template <typename Heuristic, typename IsGoal>
+std::vector<std::vector<Vec2i>> Pathfinder::search(const Grid& grid, const Vec2i& start,
+    bool allowDiagonal, Heuristic heuristic, IsGoal isGoal, size_t maxGoals,
+    bool reopenClosed, size_t expectedNodes, SearchStats& stats)
+{
+    return withNodeStore(grid, expectedNodes, stats, [&](auto& nodes) {
+        return runSearch(grid, start, allowDiagonal, heuristic, isGoal, maxGoals,
+            reopenClosed, nodes, stats);
+    });
+}
+
 std::vector<Vec2i> Pathfinder::findPath(const Grid& grid,
     const Vec2i& start, const Vec2i& end)
 {
+    m_lastStats = SearchStats();
+
     if (!grid.isInBounds(start) || !grid.isInBounds(end)) {
         return {};
     }
 
-    const int width = grid.getWidth();
-    const int height = grid.getHeight();
+    auto paths = search(grid, start, m_allowDiagonal,
+        [&](const Vec2i& pos) { return heuristic(pos, end); },
+        [&](const Vec2i& pos) { return pos == end; },
+        1, false, expectedSearchArea(start, end), m_lastStats);
+
+    // Open set exhausted with no path to goal
+    if (paths.empty()) {
+        return {};
+    }
+    return std::move(paths.front());
+}
+
+std::vector<Vec2i> Pathfinder::findPath(const Grid& grid,
+    const Vec2i& start, const Vec2i& end, const SearchOptions& options)
+{
+    const float epsilon = std::max(options.epsilon, 0.0f);
+
+    if (options.mode == SearchMode::TableLookup) {
+        const FirstMoveTable* table = options.firstMoveTable;
+        if (!table || !table->matches(grid) || table->getAllowDiagonal() != m_allowDiagonal) {
+            return findPath(grid, start, end);
+        }
+
+        // One lookup per step; nothing is generated
+        m_lastStats = SearchStats();
+        std::vector<Vec2i> path = table->extractPath(start, end);
+        m_lastStats.nodesExpanded = static_cast<int>(path.size());
+        return path;
+    }
+
+    if (options.mode == SearchMode::Subgoal) {
+        const SubgoalGraph* graph = options.subgoalGraph;
+        if (!graph || !graph->matches(grid) || !m_allowDiagonal
+            || !grid.isWalkable(start) || !grid.isWalkable(end)) {
+            return findPath(grid, start, end);
+        }
+        return findPathWithSubgoals(grid, start, end, *graph);
+    }
+
+    if (options.mode == SearchMode::Optimal || epsilon == 0.0f) {
+        return findPath(grid, start, end);
+    }
+
+    m_lastStats = SearchStats();
+
+    if (!grid.isInBounds(start) || !grid.isInBounds(end)) {
+        return {};
+    }
+
+    const double weight = 1.0 + epsilon;
+    std::vector<std::vector<Vec2i>> paths;
+
+    switch (options.mode) {
+    case SearchMode::Weighted:
+    {
+        // Inflates and rounds down the step costs rather than the heuristic,
+        // which would then not be consistent with steps of weight times their
+        // cost by up to one unit. This way it is, and never exceeds weight
+        // times the true distance, so closed nodes never need reopening to
+        // keep the bound.
+        const int cardinalCost = static_cast<int>(std::floor(Movement::CARDINAL_COST * weight));
+        const int diagonalCost = static_cast<int>(std::floor(Movement::DIAGONAL_COST * weight));
+
+        paths = search(grid, start, m_allowDiagonal,
+            [&](const Vec2i& pos) {
+                return scaledDistance(pos, end, m_allowDiagonal, cardinalCost, diagonalCost);
+            },
+            [&](const Vec2i& pos) { return pos == end; },
+            1, false, expectedSearchArea(start, end), m_lastStats);
+        break;
+    }
+
+    case SearchMode::DynamicWeighted:
+    {
+        // Weight scales with the remaining share of the start-to-goal estimate.
+        // Rounded down, the heuristic never exceeds (1 + epsilon) times the
+        // true distance, which is all the bound needs once closed nodes are
+        // reopened.
+        const double startEstimate = std::max(heuristic(start, end), 1);
+
+        paths = search(grid, start, m_allowDiagonal,
+            [&](const Vec2i& pos) {
+                int h = heuristic(pos, end);
+                double progress = std::min(1.0, h / startEstimate);
+                return static_cast<int>(std::floor(h * (1.0 + epsilon * progress)));
+            },
+            [&](const Vec2i& pos) { return pos == end; },
+            1, true, expectedSearchArea(start, end), m_lastStats);
+        break;
+    }
+
+    case SearchMode::Focal:
+        return withNodeStore(grid, expectedSearchArea(start, end), m_lastStats, [&](auto& nodes) {
+            return runFocalSearch(grid, start, end, m_allowDiagonal, epsilon, nodes, m_lastStats);
+        });
 
-    // Open set: nodes to evaluate, sorted by lowest f-cost
-    std::priority_queue<PathNode*, std::vector<PathNode*>, ComparePathNode> openSet;
+    default:
+        break;
+    }
 
-    // Owns all allocated nodes  ensures cleanup when the function returns
-    std::vector<std::unique_ptr<PathNode>> allNodes;
+    if (paths.empty()) {
+        return {};
+    }
+    return std::move(paths.front());
+}
 
-    // Maps grid positions to their nodes for O(1) lookup
-    std::unordered_map<Vec2i, PathNode*> nodeMap;
+std::vector<Vec2i> Pathfinder::findPathToNearest(const Grid& grid,
+    const Vec2i& start, const std::vector<Vec2i>& targets)
+{
+    auto paths = findPathsToNearest(grid, start, targets, 1);
 
-    // Closed set: nodes already fully evaluated
-    std::vector<std::vector<bool>> closedSet(height, std::vector<bool>(width, false));
+    if (paths.empty()) {
+        return {};
+    }
+    return std::move(paths.front());
+}
 
-    // Seed the open set with the start node
-    auto startNode = std::make_unique<PathNode>(start);
-    startNode->gCost = 0;
-    startNode->hCost = heuristic(start, end);
+std::vector<std::vector<Vec2i>> Pathfinder::findPathsToNearest(const Grid& grid,
+    const Vec2i& start, const std::vector<Vec2i>& targets, size_t maxPaths)
+{
+    m_lastStats = SearchStats();
 
-    PathNode* startPtr = startNode.get();
-    nodeMap[start] = startPtr;
-    allNodes.push_back(std::move(startNode));
-    openSet.push(startPtr);
+    if (!grid.isInBounds(start) || maxPaths == 0) {
+        return {};
+    }
+
+    const int width = grid.getWidth();
 
-    while (!openSet.empty()) {
-        // Pick the node with the lowest f-cost
-        PathNode* current = openSet.top();
-        openSet.pop();
+    // Deduplicate targets and drop any that can never be reached
+    std::vector<bool> isTarget(static_cast<size_t>(width) * grid.getHeight(), false);
+    std::vector<Vec2i> validTargets;
 
-        // Skip stale entries (node was already evaluated via a cheaper path)
-        if (closedSet[current->pos.y][current->pos.x]) {
+    for (const Vec2i& target : targets) {
+        if (!grid.isWalkable(target) && target != start) {
             continue;
         }
 
-        // Goal reached  reconstruct and return the path
-        if (current->pos == end) {
-            return reconstructPath(current);
+        size_t index = static_cast<size_t>(target.y) * width + target.x;
+        if (!isTarget[index]) {
+            isTarget[index] = true;
+            validTargets.push_back(target);
         }
+    }
 
-        closedSet[current->pos.y][current->pos.x] = true;
+    if (validTargets.empty()) {
+        return {};
+    }
 
-        // Expand cardinal neighbors (up, down, left, right)
-        for (const Vec2i& dir : CARDINAL_DIRS) {
-            Vec2i neighborPos = current->pos + dir;
+    // Corners of the box around the start and every target
+    Vec2i low = start;
+    Vec2i high = start;
+    for (const Vec2i& target : validTargets) {
+        low = { std::min(low.x, target.x), std::min(low.y, target.y) };
+        high = { std::max(high.x, target.x), std::max(high.y, target.y) };
+    }
 
-            if (!grid.isWalkable(neighborPos) || closedSet[neighborPos.y][neighborPos.x]) {
-                continue;
-            }
+    auto isGoal = [&](const Vec2i& pos) {
+        return isTarget[static_cast<size_t>(pos.y) * width + pos.x];
+    };
 
-            expandNeighbor(neighborPos, current->gCost + CARDINAL_COST,
-                heuristic(neighborPos, end), current,
-                openSet, allNodes, nodeMap);
-        }
+    // The minimum over targets is admissible and consistent, but evaluating it
+    // costs O(N) per node. Past a handful of targets a plain Dijkstra is cheaper.
+    if (validTargets.size() > MULTI_TARGET_HEURISTIC_LIMIT) {
+        return search(grid, start, m_allowDiagonal,
+            [](const Vec2i&) { return 0; },
+            isGoal, maxPaths, false, expectedSearchArea(low, high), m_lastStats);
+    }
 
-        // Expand diagonal neighbors if enabled
-        if (m_allowDiagonal) {
-            for (const Vec2i& dir : DIAGONAL_DIRS) {
-                Vec2i neighborPos = current->pos + dir;
+    return search(grid, start, m_allowDiagonal,
+        [&](const Vec2i& pos) {
+            int best = heuristic(pos, validTargets.front());
+            for (const Vec2i& target : validTargets) {
+                best = std::min(best, heuristic(pos, target));
+            }
+            return best;
+        },
+        isGoal, maxPaths, false, expectedSearchArea(low, high), m_lastStats);
+}
 
-                if (!grid.isWalkable(neighborPos) || closedSet[neighborPos.y][neighborPos.x]) {
-                    continue;
-                }
+std::vector<Vec2i> Pathfinder::findPathWithSubgoals(const Grid& grid,
+    const Vec2i& start, const Vec2i& end, const SubgoalGraph& graph)
+{
+    m_lastStats = SearchStats();
 
-                // Corner-cutting check: both adjacent cardinal cells must be walkable
-                // e.g. to move top-left, both "top" and "left" must be open
-                Vec2i adjacentA = { current->pos.x + dir.x, current->pos.y };
-                Vec2i adjacentB = { current->pos.x, current->pos.y + dir.y };
+    std::vector<Vec2i> waypoints = graph.findWaypoints(grid, start, end, m_lastStats);
+    if (waypoints.empty()) {
+        return {};
+    }
 
-                if (!grid.isWalkable(adjacentA) || !grid.isWalkable(adjacentB)) {
-                    continue;
-                }
+    std::vector<Vec2i> path = { waypoints.front() };
 
-                expandNeighbor(neighborPos, current->gCost + DIAGONAL_COST,
-                    heuristic(neighborPos, end), current,
-                    openSet, allNodes, nodeMap);
-            }
+    for (size_t i = 1; i < waypoints.size(); ++i) {
+        if (SubgoalGraph::refineSegment(grid, waypoints[i - 1], waypoints[i], path)) {
+            continue;
         }
+
+        // Every edge has a free octile shape by construction, but stay
+        // correct even if one doesn't
+        SearchStats segmentStats;
+        const Vec2i& segmentEnd = waypoints[i];
+        auto segments = search(grid, waypoints[i - 1], true,
+            [&](const Vec2i& pos) { return Movement::octileDistance(pos, segmentEnd); },
+            [&](const Vec2i& pos) { return pos == segmentEnd; },
+            1, false, expectedSearchArea(waypoints[i - 1], segmentEnd), segmentStats);
+
+        if (segments.empty()) {
+            return {};
+        }
+        path.insert(path.end(), segments.front().begin() + 1, segments.front().end());
     }
 
-    // Open set exhausted with no path to goal
-    return {};
+    return path;
 }
 
 int Pathfinder::heuristic(const Vec2i& a, const Vec2i& b) const {
-    return m_allowDiagonal ? octileDistance(a, b) : manhattanDistance(a, b);
-}
-
-int Pathfinder::manhattanDistance(const Vec2i& a, const Vec2i& b) {
-    return (std::abs(a.x - b.x) + std::abs(a.y - b.y)) * CARDINAL_COST;
-}
-
-int Pathfinder::octileDistance(const Vec2i& a, const Vec2i& b) {
-    int dx = std::abs(a.x - b.x);
-    int dy = std::abs(a.y - b.y);
-    return CARDINAL_COST * (dx + dy) + (DIAGONAL_COST - 2 * CARDINAL_COST) * std::min(dx, dy);
+    return Movement::distance(a, b, m_allowDiagonal);
 }
\ No newline at end of file
@@ -1,8 +1,58 @@
 #pragma once
 #include "Grid.h"
+#include "NodeStore.h"
 #include "Vec2i.h"
 #include <vector>
 
+class FirstMoveTable;
+class SubgoalGraph;
+
+// Counters describing the most recent search
+struct SearchStats {
+    int nodesExpanded = 0;
+    int nodesGenerated = 0;
+
+    // True if the search kept its state in a SparseNodeStore
+    bool sparseState = false;
+};
+
+// How findPath trades path cost for search effort. Every mode other than
+// Optimal returns a path costing at most (1 + epsilon) times the optimum.
+enum class SearchMode {
+    Optimal,
+
+    // A* with the heuristic inflated by (1 + epsilon)
+    Weighted,
+
+    // Inflation fades from (1 + epsilon) near the start to none near the
+    // goal, so the search commits early and stays careful at the end
+    DynamicWeighted,
+
+    // A*-epsilon: expands whichever node within (1 + epsilon) of the best
+    // f-cost is closest to the goal
+    Focal,
+
+    // Optimal path read from a prebuilt FirstMoveTable, no search at all.
+    // Falls back to Optimal if the table is missing or out of date.
+    TableLookup,
+
+    // Optimal path found by searching a prebuilt SubgoalGraph and refining
+    // its edges into cells. Diagonal movement only; falls back to Optimal
+    // otherwise, or if the graph is missing or out of date.
+    Subgoal
+};
+
+struct SearchOptions {
+    SearchMode mode = SearchMode::Optimal;
+    float epsilon = 0.0f;
+
+    // TableLookup only
+    const FirstMoveTable* firstMoveTable = nullptr;
+
+    // Subgoal only
+    const SubgoalGraph* subgoalGraph = nullptr;
+};
+
 class Pathfinder {
 public:
     Pathfinder();
@@ -13,13 +63,58 @@ public:
     std::vector<Vec2i> findPath(const Grid& grid,
         const Vec2i& start, const Vec2i& end);
 
+    // Same query with a bounded-suboptimal search mode chosen per call
+    std::vector<Vec2i> findPath(const Grid& grid,
+        const Vec2i& start, const Vec2i& end, const SearchOptions& options);
+
+    // Path to whichever target is cheapest to reach, in a single search.
+    // Returns an empty path if none of the targets is reachable.
+    std::vector<Vec2i> findPathToNearest(const Grid& grid,
+        const Vec2i& start, const std::vector<Vec2i>& targets);
+
+    // Paths to up to maxPaths of the nearest reachable targets, closest first
+    std::vector<std::vector<Vec2i>> findPathsToNearest(const Grid& grid,
+        const Vec2i& start, const std::vector<Vec2i>& targets, size_t maxPaths);
+
+    const SearchStats& getLastSearchStats() const { return m_lastStats; }
+
 private:
     bool m_allowDiagonal;
+    SearchStats m_lastStats;
+
+    // Search state, kept between queries to reuse its memory. Memory
+    // policy: the dense store is only used on grids of up to
+    // MAX_DENSE_CELLS cells, so it never holds more than about 24 MB, and
+    // larger grids always search with the sparse store. A sparse store left
+    // with more than MAX_DENSE_CELLS slots by a query is freed after it, so
+    // a Pathfinder (one per PathServer worker) holds on to at most a few
+    // tens of MB between queries whatever the grid size.
+    DenseNodeStore m_denseNodes;
+    SparseNodeStore m_sparseNodes;
 
-    static constexpr int CARDINAL_COST = 10;
-    static constexpr int DIAGONAL_COST = 14;
+    // Searches expected to touch less than this fraction of the grid keep
+    // their state in the sparse store instead of grid-sized arrays
+    static constexpr size_t SPARSE_AREA_DIVISOR = 16;
+
+    // 1024x1024
+    static constexpr size_t MAX_DENSE_CELLS = size_t(1) << 20;
+
+    // Above this many targets, nearest-target queries drop the heuristic
+    // and run as a plain Dijkstra
+    static constexpr size_t MULTI_TARGET_HEURISTIC_LIMIT = 16;
 
     int heuristic(const Vec2i& a, const Vec2i& b) const;
-    static int manhattanDistance(const Vec2i& a, const Vec2i& b);
-    static int octileDistance(const Vec2i& a, const Vec2i& b);
+
+    // Resets whichever node store suits expectedNodes and passes it to run
+    template <typename Run>
+    auto withNodeStore(const Grid& grid, size_t expectedNodes, SearchStats& stats, Run run);
+
+    // Runs the shared A* loop on whichever node store suits expectedNodes
+    template <typename Heuristic, typename IsGoal>
+    std::vector<std::vector<Vec2i>> search(const Grid& grid, const Vec2i& start,
+        bool allowDiagonal, Heuristic heuristic, IsGoal isGoal, size_t maxGoals,
+        bool reopenClosed, size_t expectedNodes, SearchStats& stats);
+
+    std::vector<Vec2i> findPathWithSubgoals(const Grid& grid,
+        const Vec2i& start, const Vec2i& end, const SubgoalGraph& graph);
 };
\ No newline at end of file
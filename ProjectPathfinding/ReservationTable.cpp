@@ -0,0 +1,69 @@
+#include "ReservationTable.h"
+#include <algorithm>
+#include <cassert>
+
+ReservationTable::ReservationTable()
+    : m_width(0)
+    , m_height(0)
+    , m_depth(0)
+    , m_wordsPerStep(0)
+{
+}
+
+void ReservationTable::reset(int width, int height, int depth) {
+    m_width = width;
+    m_height = height;
+    m_depth = depth;
+
+    const size_t cellCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+    m_wordsPerStep = (cellCount + 63) / 64;
+
+    m_bits.assign(m_wordsPerStep * static_cast<size_t>(depth), 0);
+}
+
+void ReservationTable::clear() {
+    std::fill(m_bits.begin(), m_bits.end(), 0);
+}
+
+void ReservationTable::reserve(const Vec2i& pos, int time) {
+    if (time < 0 || time >= m_depth) {
+        return;
+    }
+    m_bits[wordIndex(pos, time)] |= bitMask(pos, m_width);
+}
+
+void ReservationTable::release(const Vec2i& pos, int time) {
+    if (time < 0 || time >= m_depth) {
+        return;
+    }
+    m_bits[wordIndex(pos, time)] &= ~bitMask(pos, m_width);
+}
+
+bool ReservationTable::isReserved(const Vec2i& pos, int time) const {
+    if (time < 0 || time >= m_depth) {
+        return false;
+    }
+    return (m_bits[wordIndex(pos, time)] & bitMask(pos, m_width)) != 0;
+}
+
+bool ReservationTable::isReservedFrom(const Vec2i& pos, int fromTime) const {
+    for (int t = std::max(fromTime, 0); t < m_depth; ++t) {
+        if (isReserved(pos, t)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t ReservationTable::wordIndex(const Vec2i& pos, int time) const {
+    assert(pos.x >= 0 && pos.x < m_width && pos.y >= 0 && pos.y < m_height
+        && "Reservation coordinates out of bounds");
+
+    size_t cell = static_cast<size_t>(pos.y) * static_cast<size_t>(m_width) + static_cast<size_t>(pos.x);
+    return static_cast<size_t>(time) * m_wordsPerStep + cell / 64;
+}
+
+uint64_t ReservationTable::bitMask(const Vec2i& pos, int width) {
+    size_t cell = static_cast<size_t>(pos.y) * static_cast<size_t>(width) + static_cast<size_t>(pos.x);
+    return uint64_t(1) << (cell % 64);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Vec2i.h"
+#include <cstdint>
+#include <vector>
+
+// Space-time occupancy for cooperative planning.
+// One bitset of width * height bits per timestep of the planning window,
+// so a reservation check is a shift and a mask rather than a hash lookup.
+class ReservationTable {
+public:
+    ReservationTable();
+
+    // Resizes the table and clears every reservation
+    void reset(int width, int height, int depth);
+    void clear();
+
+    // Timesteps are relative to the start of the current window, [0, depth)
+    void reserve(const Vec2i& pos, int time);
+    void release(const Vec2i& pos, int time);
+    bool isReserved(const Vec2i& pos, int time) const;
+
+    // True if pos is reserved at any time in [fromTime, depth)
+    bool isReservedFrom(const Vec2i& pos, int fromTime) const;
+
+    int getDepth() const { return m_depth; }
+
+private:
+    int m_width;
+    int m_height;
+    int m_depth;
+    size_t m_wordsPerStep;
+    std::vector<uint64_t> m_bits;
+
+    size_t wordIndex(const Vec2i& pos, int time) const;
+    static uint64_t bitMask(const Vec2i& pos, int width);
+};
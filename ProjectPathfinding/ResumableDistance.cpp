@@ -0,0 +1,70 @@
+#include "ResumableDistance.h"
+#include "Movement.h"
+
+ResumableDistance::ResumableDistance()
+    : m_allowDiagonal(false)
+    , m_origin(0, 0)
+{
+}
+
+void ResumableDistance::reset(const Grid& grid, const Vec2i& goal, const Vec2i& origin, bool allowDiagonal) {
+    m_allowDiagonal = allowDiagonal;
+    m_origin = origin;
+    m_nodes.reset(0);
+    m_openSet = {};
+
+    if (!grid.isWalkable(goal)) {
+        return;
+    }
+
+    int hCost = Movement::distance(goal, origin, m_allowDiagonal);
+    m_nodes.insert(goal) = { 0, hCost, goal, false };
+    m_openSet.push({ hCost, hCost, goal });
+}
+
+int ResumableDistance::getDistance(const Grid& grid, const Vec2i& pos) {
+    // Walls would never close, and asking would exhaust the search
+    if (!grid.isWalkable(pos)) {
+        return UNREACHABLE;
+    }
+
+    while (true) {
+        const SearchNode* target = m_nodes.find(pos);
+        if (target && target->closed) {
+            return target->gCost;
+        }
+        if (m_openSet.empty()) {
+            return UNREACHABLE;
+        }
+
+        OpenEntry entry = m_openSet.top();
+        m_openSet.pop();
+
+        SearchNode* current = m_nodes.find(entry.pos);
+        if (current->closed || entry.fCost != current->gCost + current->hCost) {
+            continue;
+        }
+        current->closed = true;
+
+        // Copied, since inserting below may move the node
+        const Vec2i currentPos = entry.pos;
+        const int gCost = current->gCost;
+
+        // Moves are symmetric, so expanding away from the goal yields
+        // distances towards it
+        Movement::forEachNeighbor(grid, currentPos, m_allowDiagonal, [&](const Vec2i& next, int cost) {
+            SearchNode* neighbor = m_nodes.find(next);
+
+            if (!neighbor) {
+                int hCost = Movement::distance(next, m_origin, m_allowDiagonal);
+                m_nodes.insert(next) = { gCost + cost, hCost, currentPos, false };
+                m_openSet.push({ gCost + cost + hCost, hCost, next });
+            }
+            else if (!neighbor->closed && gCost + cost < neighbor->gCost) {
+                neighbor->gCost = gCost + cost;
+                neighbor->parent = currentPos;
+                m_openSet.push({ neighbor->gCost + neighbor->hCost, neighbor->hCost, next });
+            }
+        });
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Grid.h"
+#include "NodeStore.h"
+#include "Vec2i.h"
+#include <climits>
+#include <queue>
+#include <vector>
+
+// True distances to one goal, computed only as far as they are asked for
+// (Reverse Resumable A*). A backward A* runs from the goal towards an
+// origin cell, and pauses as soon as the cell being asked about is closed;
+// later queries resume it from where it stopped. Closed cells are exact
+// with a consistent heuristic, whichever cell the search is aimed at, so a
+// map costs about one search from the goal to the origin instead of a pass
+// over the whole grid, and memory follows the explored area.
+class ResumableDistance {
+public:
+    static constexpr int UNREACHABLE = INT_MAX;
+
+    ResumableDistance();
+
+    // Starts over from goal, aimed at origin. Moves use the same 10/14 costs
+    // and corner-cutting rule as Pathfinder::findPath.
+    void reset(const Grid& grid, const Vec2i& goal, const Vec2i& origin, bool allowDiagonal);
+
+    // Distance from pos to the goal, resuming the search until pos is closed.
+    // The grid must be the one passed to reset() and must not have changed.
+    int getDistance(const Grid& grid, const Vec2i& pos);
+
+    // Cells generated so far
+    size_t getNodeCount() const { return m_nodes.size(); }
+
+private:
+    struct OpenEntry {
+        int fCost;
+        int hCost;
+        Vec2i pos;
+    };
+
+    struct CompareOpenEntry {
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const {
+            if (a.fCost == b.fCost) {
+                return a.hCost > b.hCost;
+            }
+            return a.fCost > b.fCost;
+        }
+    };
+
+    bool m_allowDiagonal;
+    Vec2i m_origin;
+    SparseNodeStore m_nodes;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, CompareOpenEntry> m_openSet;
+};
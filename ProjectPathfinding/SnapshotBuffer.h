@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+
+// Lock-free hand-off of snapshots from one writer thread to one reader thread.
+//
+// The writer fills back() and calls publish(); the reader calls acquire()
+// to get the newest published snapshot. Three slots rotate between the two
+// sides (writer's back buffer, reader's front buffer, and the latest
+// published one in between), so neither side ever waits on the other and
+// the reader's snapshot is never touched until its next acquire(). Slots
+// are reused, so the writer sees whatever it wrote into a slot two
+// publishes ago and can refresh only what changed.
+template <typename T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer()
+        : m_shared(1)
+        , m_backIndex(0)
+        , m_frontIndex(2)
+    {
+    }
+
+    SnapshotBuffer(const SnapshotBuffer&) = delete;
+    SnapshotBuffer& operator=(const SnapshotBuffer&) = delete;
+
+    // Writer side
+    T& back() { return m_slots[m_backIndex]; }
+
+    void publish() {
+        m_backIndex = m_shared.exchange(m_backIndex | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side. The returned snapshot stays valid and unchanged until the
+    // next call; if nothing new was published, the previous one is returned.
+    const T& acquire() {
+        if (m_shared.load(std::memory_order_relaxed) & FRESH_BIT) {
+            m_frontIndex = m_shared.exchange(m_frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return m_slots[m_frontIndex];
+    }
+
+private:
+    static constexpr unsigned INDEX_MASK = 0x3;
+    static constexpr unsigned FRESH_BIT = 0x4;
+
+    T m_slots[3];
+
+    // Index of the slot in the middle, plus FRESH_BIT if the reader hasn't taken it yet
+    std::atomic<unsigned> m_shared;
+
+    unsigned m_backIndex;
+    unsigned m_frontIndex;
+};
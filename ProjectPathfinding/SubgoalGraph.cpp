@@ -0,0 +1,316 @@
+#include "SubgoalGraph.h"
+#include "Movement.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+
+    Vec2i offset(const Vec2i& pos, const Vec2i& dir, int steps) {
+        return { pos.x + dir.x * steps, pos.y + dir.y * steps };
+    }
+
+    bool canStep(const Grid& grid, const Vec2i& from, const Vec2i& dir) {
+        bool diagonal = dir.x != 0 && dir.y != 0;
+        return grid.isWalkable(from + dir) && (!diagonal || Movement::isDiagonalClear(grid, from, dir));
+    }
+
+    // Octile-distance path from 'from' to 'to' as one straight and one
+    // diagonal leg, in the requested order. Fails if a step is blocked.
+    bool walkOctile(const Grid& grid, const Vec2i& from, const Vec2i& to,
+        bool diagonalFirst, std::vector<Vec2i>& cells)
+    {
+        int dx = to.x - from.x;
+        int dy = to.y - from.y;
+        int stepX = (dx > 0) - (dx < 0);
+        int stepY = (dy > 0) - (dy < 0);
+
+        int diagonalSteps = std::min(std::abs(dx), std::abs(dy));
+        int straightSteps = std::max(std::abs(dx), std::abs(dy)) - diagonalSteps;
+
+        Vec2i diagonal = { stepX, stepY };
+        Vec2i straight = std::abs(dx) > std::abs(dy) ? Vec2i(stepX, 0) : Vec2i(0, stepY);
+
+        const std::pair<Vec2i, int> legs[2] = {
+            diagonalFirst ? std::make_pair(diagonal, diagonalSteps) : std::make_pair(straight, straightSteps),
+            diagonalFirst ? std::make_pair(straight, straightSteps) : std::make_pair(diagonal, diagonalSteps)
+        };
+
+        Vec2i pos = from;
+        for (const auto& leg : legs) {
+            for (int i = 0; i < leg.second; ++i) {
+                if (!canStep(grid, pos, leg.first)) {
+                    return false;
+                }
+                pos = pos + leg.first;
+                cells.push_back(pos);
+            }
+        }
+        return true;
+    }
+
+} // anonymous namespace
+
+SubgoalGraph::SubgoalGraph()
+    : m_built(false)
+    , m_width(0)
+    , m_height(0)
+    , m_gridContentId(0)
+    , m_buildSeconds(0.0)
+{
+}
+
+bool SubgoalGraph::isSubgoalCell(const Grid& grid, const Vec2i& pos) const {
+    if (!grid.isWalkable(pos)) {
+        return false;
+    }
+
+    // Convex obstacle corner: the diagonal is blocked but both cells beside it are open
+    for (const Vec2i& dir : Movement::DIAGONAL_DIRS) {
+        if (!grid.isInBounds(pos + dir) || grid.isWalkable(pos + dir)) {
+            continue;
+        }
+        if (Movement::isDiagonalClear(grid, pos, dir)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Found>
+void SubgoalGraph::forEachDirectHReachable(const Grid& grid, const Vec2i& origin,
+    const Vec2i* extra, Found&& found) const
+{
+    auto isTarget = [&](const Vec2i& pos) {
+        return (extra && pos == *extra)
+            || (grid.isInBounds(pos) && m_subgoalIndex[static_cast<size_t>(pos.y) * m_width + pos.x] >= 0);
+    };
+
+    // Steps that can be taken from pos along dir before hitting a wall or a target
+    auto clearance = [&](const Vec2i& pos, const Vec2i& dir) {
+        int steps = 0;
+        Vec2i current = pos;
+        while (canStep(grid, current, dir) && !isTarget(current + dir)) {
+            current = current + dir;
+            ++steps;
+        }
+        return steps;
+    };
+
+    // Reports the cell just past a ray if the ray was stopped by a target
+    auto reportBeyond = [&](const Vec2i& pos, const Vec2i& dir, int steps) {
+        Vec2i last = offset(pos, dir, steps);
+        if (canStep(grid, last, dir) && isTarget(last + dir)) {
+            found(last + dir);
+        }
+    };
+
+    for (const Vec2i& dir : Movement::CARDINAL_DIRS) {
+        reportBeyond(origin, dir, clearance(origin, dir));
+    }
+
+    // Each diagonal sweeps a wedge: walk the diagonal and cast both of its
+    // cardinal components from every cell on it. A ray may never reach
+    // further than the one before it, since anything beyond is either
+    // blocked or reached more directly through a subgoal already found.
+    for (const Vec2i& dir : Movement::DIAGONAL_DIRS) {
+        const Vec2i components[2] = { { dir.x, 0 }, { 0, dir.y } };
+        int maxSteps[2] = { clearance(origin, components[0]), clearance(origin, components[1]) };
+
+        int diagonalSteps = clearance(origin, dir);
+        reportBeyond(origin, dir, diagonalSteps);
+
+        for (int i = 1; i <= diagonalSteps; ++i) {
+            Vec2i pos = offset(origin, dir, i);
+
+            for (int k = 0; k < 2; ++k) {
+                int steps = clearance(pos, components[k]);
+                if (steps <= maxSteps[k]) {
+                    reportBeyond(pos, components[k], steps);
+                }
+                maxSteps[k] = std::min(maxSteps[k], steps);
+            }
+        }
+    }
+}
+
+void SubgoalGraph::build(const Grid& grid) {
+    auto buildStart = std::chrono::steady_clock::now();
+
+    m_width = grid.getWidth();
+    m_height = grid.getHeight();
+    m_gridContentId = grid.getContentId();
+    m_subgoals.clear();
+    m_subgoalIndex.assign(static_cast<size_t>(m_width) * m_height, -1);
+
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            if (isSubgoalCell(grid, { x, y })) {
+                m_subgoalIndex[static_cast<size_t>(y) * m_width + x] = static_cast<int>(m_subgoals.size());
+                m_subgoals.push_back({ x, y });
+            }
+        }
+    }
+
+    // Reachability is symmetric, so store every edge in both directions
+    std::vector<std::vector<int>> adjacency(m_subgoals.size());
+
+    for (size_t i = 0; i < m_subgoals.size(); ++i) {
+        forEachDirectHReachable(grid, m_subgoals[i], nullptr, [&](const Vec2i& cell) {
+            int j = m_subgoalIndex[static_cast<size_t>(cell.y) * m_width + cell.x];
+            adjacency[i].push_back(j);
+            adjacency[j].push_back(static_cast<int>(i));
+        });
+    }
+
+    m_edges.clear();
+    m_edgeOffsets.assign(1, 0);
+
+    for (auto& neighbors : adjacency) {
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+        m_edges.insert(m_edges.end(), neighbors.begin(), neighbors.end());
+        m_edgeOffsets.push_back(m_edges.size());
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - buildStart;
+    m_buildSeconds = elapsed.count();
+    m_built = true;
+}
+
+bool SubgoalGraph::matches(const Grid& grid) const {
+    return m_built
+        && grid.getWidth() == m_width
+        && grid.getHeight() == m_height
+        && grid.getContentId() == m_gridContentId;
+}
+
+std::vector<Vec2i> SubgoalGraph::findWaypoints(const Grid& grid, const Vec2i& start,
+    const Vec2i& goal, SearchStats& stats) const
+{
+    if (start == goal) {
+        return { start };
+    }
+
+    // Start and goal join the graph as two temporary nodes after the subgoals
+    const int subgoalCount = static_cast<int>(m_subgoals.size());
+    const int startNode = subgoalCount;
+    const int goalNode = subgoalCount + 1;
+
+    auto position = [&](int node) {
+        return node == startNode ? start : node == goalNode ? goal : m_subgoals[node];
+    };
+
+    std::vector<int> startEdges;
+    forEachDirectHReachable(grid, start, &goal, [&](const Vec2i& cell) {
+        startEdges.push_back(cell == goal
+            ? goalNode
+            : m_subgoalIndex[static_cast<size_t>(cell.y) * m_width + cell.x]);
+    });
+
+    std::vector<bool> linksToGoal(static_cast<size_t>(subgoalCount), false);
+    forEachDirectHReachable(grid, goal, nullptr, [&](const Vec2i& cell) {
+        linksToGoal[m_subgoalIndex[static_cast<size_t>(cell.y) * m_width + cell.x]] = true;
+    });
+
+    const size_t nodeCount = static_cast<size_t>(subgoalCount) + 2;
+    std::vector<int> gCosts(nodeCount, INT_MAX);
+    std::vector<int> parents(nodeCount, -1);
+    std::vector<bool> closed(nodeCount, false);
+
+    using OpenEntry = std::pair<int, int>;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openSet;
+
+    auto relax = [&](int from, int to) {
+        int gCost = gCosts[from] + Movement::octileDistance(position(from), position(to));
+        if (gCost < gCosts[to]) {
+            if (gCosts[to] == INT_MAX) {
+                ++stats.nodesGenerated;
+            }
+            gCosts[to] = gCost;
+            parents[to] = from;
+            openSet.push({ gCost + Movement::octileDistance(position(to), goal), to });
+        }
+    };
+
+    gCosts[startNode] = 0;
+    openSet.push({ Movement::octileDistance(start, goal), startNode });
+    ++stats.nodesGenerated;
+
+    int reached = -1;
+
+    while (!openSet.empty()) {
+        int node = openSet.top().second;
+        openSet.pop();
+
+        if (closed[node]) {
+            continue;
+        }
+        closed[node] = true;
+
+        // A subgoal sitting on the goal cell counts as reaching it
+        if (node == goalNode || position(node) == goal) {
+            reached = node;
+            break;
+        }
+
+        ++stats.nodesExpanded;
+
+        if (node == startNode) {
+            for (int next : startEdges) {
+                relax(node, next);
+            }
+            continue;
+        }
+
+        for (size_t e = m_edgeOffsets[node]; e < m_edgeOffsets[node + 1]; ++e) {
+            relax(node, m_edges[e]);
+        }
+        if (linksToGoal[node]) {
+            relax(node, goalNode);
+        }
+    }
+
+    if (reached < 0) {
+        return {};
+    }
+
+    std::vector<Vec2i> waypoints;
+    for (int node = reached; node >= 0; node = parents[node]) {
+        // A start cell that is also a subgoal would otherwise appear twice
+        if (waypoints.empty() || waypoints.back() != position(node)) {
+            waypoints.push_back(position(node));
+        }
+    }
+
+    std::reverse(waypoints.begin(), waypoints.end());
+    return waypoints;
+}
+
+bool SubgoalGraph::refineSegment(const Grid& grid, const Vec2i& from, const Vec2i& to,
+    std::vector<Vec2i>& path)
+{
+    // Edges are found diagonal-first from one end, so walking them from the
+    // other end needs the mirrored, cardinal-first shape
+    std::vector<Vec2i> cells;
+    for (bool diagonalFirst : { true, false }) {
+        cells.clear();
+        if (walkOctile(grid, from, to, diagonalFirst, cells)) {
+            path.insert(path.end(), cells.begin(), cells.end());
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t SubgoalGraph::getMemoryBytes() const {
+    return m_subgoals.size() * sizeof(Vec2i)
+        + m_subgoalIndex.size() * sizeof(int)
+        + m_edges.size() * sizeof(int)
+        + m_edgeOffsets.size() * sizeof(size_t);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "Grid.h"
+#include "Pathfinder.h"
+#include "Vec2i.h"
+#include <vector>
+
+// Simple subgoal graph over an 8-connected Grid.
+//
+// Subgoals sit at the convex corners of obstacles: walkable cells whose
+// diagonal neighbor is blocked while both cells beside that diagonal are
+// open. Any shortest path only needs to turn at such corners, so searching
+// the (much smaller) graph of subgoals gives the same optimal cost as
+// searching every cell. Two subgoals are connected when they are directly
+// h-reachable: an octile-distance path joins them without passing another
+// subgoal. Edge costs are then just the octile distance.
+//
+// At query time the start and goal are linked in the same way, the graph
+// is searched with A*, and each edge is refined back into grid cells.
+// Only valid for the grid contents it was built from.
+class SubgoalGraph {
+public:
+    SubgoalGraph();
+
+    // Replaces the graph with one for the grid's current contents
+    void build(const Grid& grid);
+
+    bool isBuilt() const { return m_built; }
+
+    // True if the graph was built from this grid's current cells
+    bool matches(const Grid& grid) const;
+
+    // Subgoals an optimal path passes through, with start and goal at either
+    // end, or empty if the goal is unreachable. Adjacent entries are
+    // h-reachable from one another; see refineSegment().
+    std::vector<Vec2i> findWaypoints(const Grid& grid, const Vec2i& start,
+        const Vec2i& goal, SearchStats& stats) const;
+
+    // Appends the cells from 'from' (exclusive) to 'to' (inclusive) along an
+    // octile-distance path, trying diagonal moves first and then cardinal
+    // moves first. Returns false if neither shape is free.
+    static bool refineSegment(const Grid& grid, const Vec2i& from, const Vec2i& to,
+        std::vector<Vec2i>& path);
+
+    // Build report
+    double getBuildSeconds() const { return m_buildSeconds; }
+    size_t getSubgoalCount() const { return m_subgoals.size(); }
+    size_t getEdgeCount() const { return m_edges.size(); }
+    size_t getMemoryBytes() const;
+
+private:
+    bool m_built;
+    int m_width;
+    int m_height;
+    unsigned long long m_gridContentId;
+    double m_buildSeconds;
+
+    std::vector<Vec2i> m_subgoals;
+
+    // Per cell (row-major): subgoal index, or -1
+    std::vector<int> m_subgoalIndex;
+
+    // Neighbors of subgoal i are m_edges[m_edgeOffsets[i] .. m_edgeOffsets[i + 1])
+    std::vector<int> m_edges;
+    std::vector<size_t> m_edgeOffsets;
+
+    bool isSubgoalCell(const Grid& grid, const Vec2i& pos) const;
+
+    // Calls found(cell) for every subgoal, or 'extra' cell, directly h-reachable from origin
+    template <typename Found>
+    void forEachDirectHReachable(const Grid& grid, const Vec2i& origin,
+        const Vec2i* extra, Found&& found) const;
+};
@@ -0,0 +1,102 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace {
+
+    // Chunks per worker: enough to even out uneven work without making the
+    // shared counter a hot spot
+    constexpr size_t CHUNKS_PER_WORKER = 8;
+
+} // anonymous namespace
+
+ThreadPool::ThreadPool(unsigned workerCount)
+    : m_workerCount(workerCount > 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency()))
+    , m_body(nullptr)
+    , m_count(0)
+    , m_chunkSize(1)
+    , m_nextIndex(0)
+    , m_activeWorkers(0)
+    , m_generation(0)
+    , m_stopping(false)
+{
+    for (unsigned i = 1; i < m_workerCount; ++i) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workReady.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t, unsigned)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Not worth waking anyone for a single chunk
+    if (m_threads.empty() || count == 1) {
+        body(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_chunkSize = std::max<size_t>(1, count / (static_cast<size_t>(m_workerCount) * CHUNKS_PER_WORKER));
+        m_nextIndex.store(0, std::memory_order_relaxed);
+        m_activeWorkers = static_cast<unsigned>(m_threads.size());
+        ++m_generation;
+    }
+    m_workReady.notify_all();
+
+    runChunks(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_workDone.wait(lock, [this] { return m_activeWorkers == 0; });
+    m_body = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned workerIndex) {
+    unsigned long long seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workReady.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+
+            if (m_stopping) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        runChunks(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeWorkers;
+        }
+        m_workDone.notify_one();
+    }
+}
+
+void ThreadPool::runChunks(unsigned workerIndex) {
+    while (true) {
+        size_t begin = m_nextIndex.fetch_add(m_chunkSize, std::memory_order_relaxed);
+        if (begin >= m_count) {
+            return;
+        }
+
+        size_t end = std::min(begin + m_chunkSize, m_count);
+        (*m_body)(begin, end, workerIndex);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+// The calling thread takes part as worker 0, so a pool of N workers owns
+// N - 1 threads and a pool of 1 runs everything inline.
+class ThreadPool {
+public:
+    // 0 picks one worker per hardware thread
+    explicit ThreadPool(unsigned workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned getWorkerCount() const { return m_workerCount; }
+
+    // Splits [0, count) into chunks handed out dynamically to the workers and
+    // blocks until all of them are done. The callback receives a half-open
+    // range and the index of the worker running it, in [0, getWorkerCount()).
+    void parallelFor(size_t count, const std::function<void(size_t, size_t, unsigned)>& body);
+
+private:
+    unsigned m_workerCount;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workReady;
+    std::condition_variable m_workDone;
+
+    // Current job, published under m_mutex and identified by its generation
+    const std::function<void(size_t, size_t, unsigned)>* m_body;
+    size_t m_count;
+    size_t m_chunkSize;
+    std::atomic<size_t> m_nextIndex;
+    unsigned m_activeWorkers;
+    unsigned long long m_generation;
+    bool m_stopping;
+
+    void workerLoop(unsigned workerIndex);
+    void runChunks(unsigned workerIndex);
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <functional>
 
 struct Vec2i {
@@ -23,16 +24,27 @@ struct Vec2i {
     constexpr Vec2i operator-(const Vec2i& other) const {
         return { x - other.x, y - other.y };
     }
+
+    // Both coordinates in one 64-bit key, y in the high half
+    constexpr uint64_t packed() const {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x);
+    }
 };
 
+// splitmix64 finalizer: every input bit affects every output bit, so keys
+// that differ only in their low bits still spread across a hash table
+constexpr uint64_t mixBits(uint64_t key) {
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+    return key ^ (key >> 31);
+}
+
 // Hash function so Vec2i can be used as a key in unordered_map/unordered_set
 namespace std {
     template <>
     struct hash<Vec2i> {
         size_t operator()(const Vec2i& v) const {
-            size_t h1 = std::hash<int>{}(v.x);
-            size_t h2 = std::hash<int>{}(v.y);
-            return h1 ^ (h2 << 16);
+            return static_cast<size_t>(mixBits(v.packed()));
         }
     };
 }
@@ -1,11 +1,260 @@
 #include "Application.h"
+#include "Benchmark.h"
+#include "LoadGenerator.h"
+#include "LocalSocket.h"
+#include "PathServer.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
 
-int main() {
-    constexpr int gridWidth = 30;
-    constexpr int gridHeight = 30;
+namespace {
+
+    PathServer* g_activeServer = nullptr;
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--grid <w>x<h>] [--record <log> | --replay <log> [--headless]]\n"
+                  << "       " << program << " [--grid <w>x<h>] --pipelined [--tick-rate <hz>]\n"
+                  << "       " << program << " --serve <socket> [--grid <w>x<h>] [--grids <n>] [--workers <n>]\n"
+                  << "       " << program << " --loadgen <socket> [--requests <n>] [--connections <n>]"
+                  << " [--depth <n>] [--edits <percent>] [--grid-id <n>] [--diagonal]\n"
+                  << "       " << program << " --bench [--grid <w>x<h>] [--obstacles <percent>] [--queries <n>]"
+                  << " [--seed <n>] [--cardinal] [--table] [--subgoals] [--agents <n>] [--distances]\n";
+    }
+
+    bool parseInt(const char* text, int& value) {
+        char* end = nullptr;
+        long parsed = std::strtol(text, &end, 10);
+        if (end == text || *end != '\0') {
+            return false;
+        }
+        value = static_cast<int>(parsed);
+        return true;
+    }
+
+    bool parseArguments(int argc, char* argv[], SessionOptions& options, int& gridWidth, int& gridHeight) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+
+            if ((arg == "--record" || arg == "--replay") && i + 1 < argc) {
+                options.mode = (arg == "--record") ? SessionMode::Record : SessionMode::Replay;
+                options.inputLogPath = argv[++i];
+            }
+            else if (arg == "--headless") {
+                options.headless = true;
+            }
+            else if (arg == "--pipelined") {
+                options.pipelined = true;
+            }
+            else if (arg == "--tick-rate" && i + 1 < argc) {
+                if (!parseInt(argv[++i], options.simulationHz) || options.simulationHz <= 0) {
+                    return false;
+                }
+            }
+            else if (arg == "--grid" && i + 1 < argc) {
+                // Replays always use the size stored in the log
+                if (std::sscanf(argv[++i], "%dx%d", &gridWidth, &gridHeight) != 2 || gridWidth <= 1 || gridHeight <= 1) {
+                    return false;
+                }
+            }
+            else {
+                return false;
+            }
+        }
+
+        // Headless only makes sense when there is no live input to wait for,
+        // and recording or replaying needs the simulation in lockstep with input
+        if (options.pipelined && options.mode != SessionMode::Interactive) {
+            return false;
+        }
+        return !options.headless || options.mode == SessionMode::Replay;
+    }
+
+    int runServer(int argc, char* argv[]) {
+        int gridWidth = 512;
+        int gridHeight = 512;
+        int gridCount = 1;
+        int workers = 0;
+
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool valid = i + 1 < argc;
+
+            if (arg == "--grid" && valid) {
+                valid = std::sscanf(argv[++i], "%dx%d", &gridWidth, &gridHeight) == 2;
+            }
+            else if (arg == "--grids" && valid) {
+                valid = parseInt(argv[++i], gridCount);
+            }
+            else if (arg == "--workers" && valid) {
+                valid = parseInt(argv[++i], workers);
+            }
+            else {
+                valid = false;
+            }
+
+            if (!valid || gridWidth <= 0 || gridHeight <= 0 || gridCount <= 0 || workers < 0) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (!LocalSocket::initialize()) {
+            std::cerr << "Error: Socket initialization failed.\n";
+            return 1;
+        }
+
+        PathServer server(static_cast<unsigned>(workers));
+        for (int i = 0; i < gridCount; ++i) {
+            server.addGrid(gridWidth, gridHeight);
+        }
+
+        if (!server.listen(argv[2])) {
+            return 1;
+        }
+
+        g_activeServer = &server;
+        std::signal(SIGINT, [](int) { g_activeServer->requestStop(); });
+        std::signal(SIGTERM, [](int) { g_activeServer->requestStop(); });
+
+        std::cout << "Serving " << gridCount << " grid(s) of " << gridWidth << "x" << gridHeight
+                  << " on " << argv[2] << "\n";
+        server.run();
+
+        g_activeServer = nullptr;
+        return 0;
+    }
+
+    int runLoadGenerator(int argc, char* argv[]) {
+        LoadGeneratorOptions options;
+        options.socketPath = argv[2];
+
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool valid = i + 1 < argc;
+            int gridId = 0;
+
+            if (arg == "--diagonal") {
+                options.allowDiagonal = true;
+                valid = true;
+            }
+            else if (arg == "--requests" && valid) {
+                valid = parseInt(argv[++i], options.totalRequests);
+            }
+            else if (arg == "--connections" && valid) {
+                valid = parseInt(argv[++i], options.connections);
+            }
+            else if (arg == "--depth" && valid) {
+                valid = parseInt(argv[++i], options.pipelineDepth);
+            }
+            else if (arg == "--edits" && valid) {
+                valid = parseInt(argv[++i], options.editPercent);
+            }
+            else if (arg == "--grid-id" && valid) {
+                valid = parseInt(argv[++i], gridId) && gridId >= 0 && gridId <= 0xFFFF;
+                options.gridId = static_cast<uint16_t>(gridId);
+            }
+            else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (!LocalSocket::initialize()) {
+            std::cerr << "Error: Socket initialization failed.\n";
+            return 1;
+        }
+
+        LoadGenerator generator(options);
+        return generator.run() ? 0 : 1;
+    }
+
+    int runBenchmark(int argc, char* argv[]) {
+        BenchmarkOptions options;
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool valid = i + 1 < argc;
+            int seed = 0;
+
+            if (arg == "--cardinal") {
+                options.allowDiagonal = false;
+                valid = true;
+            }
+            else if (arg == "--table") {
+                options.firstMoveTable = true;
+                valid = true;
+            }
+            else if (arg == "--subgoals") {
+                options.subgoalGraph = true;
+                valid = true;
+            }
+            else if (arg == "--distances") {
+                options.distanceMaps = true;
+                valid = true;
+            }
+            else if (arg == "--grid" && valid) {
+                valid = std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) == 2;
+            }
+            else if (arg == "--obstacles" && valid) {
+                valid = parseInt(argv[++i], options.obstaclePercent);
+            }
+            else if (arg == "--queries" && valid) {
+                valid = parseInt(argv[++i], options.queries);
+            }
+            else if (arg == "--seed" && valid) {
+                valid = parseInt(argv[++i], seed) && seed >= 0;
+                options.seed = static_cast<unsigned>(seed);
+            }
+            else if (arg == "--agents" && valid) {
+                valid = parseInt(argv[++i], options.agents) && options.agents >= 0;
+            }
+            else {
+                valid = false;
+            }
+
+            if (!valid || options.width <= 1 || options.height <= 1 || options.queries <= 0
+                || options.obstaclePercent < 0 || options.obstaclePercent >= 100) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        Benchmark benchmark(options);
+        benchmark.run();
+        return 0;
+    }
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    // Headless service modes never touch SFML
+    if (argc >= 3 && std::string(argv[1]) == "--serve") {
+        return runServer(argc, argv);
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--loadgen") {
+        return runLoadGenerator(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench") {
+        return runBenchmark(argc, argv);
+    }
+
+    int gridWidth = 30;
+    int gridHeight = 30;
     constexpr int cellSize = 20;
 
-    Application app(gridWidth, gridHeight, cellSize);
+    SessionOptions options;
+    if (!parseArguments(argc, argv, options, gridWidth, gridHeight)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Application app(gridWidth, gridHeight, cellSize, options);
     app.run();
 
     return 0;